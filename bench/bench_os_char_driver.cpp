@@ -0,0 +1,369 @@
+/**
+ * @file	bench_os_char_driver.cpp
+ * @brief	Measures the throughput and the readline() latency of os_char_driver on the FreeRTOS Linux port.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ *
+ * The UART ISRs are simulated with signals, the same way as in the unit tests. Each benchmark prints a single line
+ * of JSON to the standard output. Usage:
+ *
+ *      JunglesOsStructs-tests-bench [--lines=N] [--line-len=N] [--burst=N] [--baud=N] [--readers=N] [--writers=N]
+ *
+ * --burst selects how many bytes are passed to a single RX ISR call; 1 uses the bytewise rx_isr_handler().
+ * --baud paces the RX as a UART running at the given baud rate (10 bits per byte) would; 0 disables the pacing.
+ * The RX buffer size and the number of the line slots are set at compile time with BENCH_RX_BUF_SIZE and
+ * BENCH_MAX_NUM_LINES.
+ */
+#include "FreeRTOS.h"
+#include "os_char_driver.hpp"
+#include "os_flag.hpp"
+#include "os_task.hpp"
+#include "task.h"
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#ifndef BENCH_RX_BUF_SIZE
+#define BENCH_RX_BUF_SIZE 1024
+#endif
+
+#ifndef BENCH_MAX_NUM_LINES
+#define BENCH_MAX_NUM_LINES 32
+#endif
+
+using namespace jungles;
+#define SIGNAL_TX SIGRTMIN
+#define SIGNAL_RX (SIGRTMIN + 1)
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+using bench_char_driver = os_char_driver<BENCH_RX_BUF_SIZE, BENCH_MAX_NUM_LINES>;
+using bench_clock = std::chrono::steady_clock;
+
+struct bench_config
+{
+    size_t num_lines = 10000;
+    //! Number of the bytes in a line, including the terminator. A line starts with its sequence number.
+    size_t line_len = 64;
+    size_t burst = 1;
+    unsigned baud = 0;
+    unsigned num_readers = 1;
+    unsigned num_writers = 1;
+};
+
+static bench_config config;
+static bench_char_driver *driver;
+
+//! The RX data currently "received" by the simulated ISR.
+static std::string_view rx_burst;
+static volatile bool is_rx_stopped;
+static volatile bool is_tx_it_enabled;
+static size_t num_tx_bytes;
+
+static void parse_args(int argc, char **argv);
+static std::string make_stream(size_t num_lines, size_t line_len);
+static double percentile(std::vector<double> &sorted, double p);
+static double seconds_since(bench_clock::time_point start);
+
+static void bench_rx();
+static void bench_tx();
+
+static void tx_isr_handler_callback(int signal);
+static void rx_isr_handler_callback(int signal);
+static void tx_it_enable();
+static void tx_it_disable();
+static void it_enable_disable();
+static void byte_send(char c);
+static void rx_stop();
+static void rx_resume();
+
+// --------------------------------------------------------------------------------------------------------------------
+// MAIN
+// --------------------------------------------------------------------------------------------------------------------
+int main(int argc, char **argv)
+{
+    parse_args(argc, argv);
+
+    xTaskCreate(
+        [](void *) {
+            std::signal(SIGNAL_TX, tx_isr_handler_callback);
+            std::signal(SIGNAL_RX, rx_isr_handler_callback);
+
+            bench_rx();
+            bench_tx();
+
+            vTaskEndScheduler();
+        },
+        "bench",
+        2048,
+        NULL,
+        1,
+        NULL);
+
+    vTaskStartScheduler();
+
+    return 0;
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE BENCHMARKS
+// --------------------------------------------------------------------------------------------------------------------
+static void bench_rx()
+{
+    bench_char_driver chardrv{it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send};
+    driver = &chardrv;
+    // Stands for RTS, so that no line is lost when the readers do not keep up.
+    auto high_watermark = BENCH_RX_BUF_SIZE > config.burst ? BENCH_RX_BUF_SIZE - config.burst : 1;
+    chardrv.enable_rx_flow_control(rx_stop, rx_resume, high_watermark, high_watermark / 2);
+    is_rx_stopped = false;
+
+    auto stream = make_stream(config.num_lines, config.line_len);
+    std::vector<bench_clock::time_point> line_completion_times(config.num_lines);
+    std::vector<std::vector<double>> latencies_us(config.num_readers);
+    std::vector<bench_clock::time_point> reader_end_times(config.num_readers, bench_clock::now());
+    std::vector<os_flag> readers_done(config.num_readers);
+    volatile bool is_feeding_done = false;
+
+    auto read_lines = [&](unsigned r) {
+        std::vector<char> buf(config.line_len);
+        auto &latencies = latencies_us[r];
+        latencies.reserve(config.num_lines);
+        while (true)
+        {
+            // Times out only when the feeding is done.
+            auto len = chardrv.readline(buf.data(), buf.size(), 100);
+            auto now = bench_clock::now();
+            if (len == 0)
+            {
+                if (is_feeding_done)
+                {
+                    readers_done[r].set();
+                    return;
+                }
+                continue;
+            }
+            reader_end_times[r] = now;
+            // The lines are shorter than the buffer, as the terminator is not stored.
+            buf[len] = '\0';
+            auto seq = std::strtoul(buf.data(), nullptr, 10);
+            latencies.push_back(std::chrono::duration<double, std::micro>(now - line_completion_times[seq]).count());
+        }
+    };
+
+    auto start = bench_clock::now();
+    std::vector<std::unique_ptr<os_task>> readers;
+    for (unsigned r = 0; r < config.num_readers; ++r)
+        readers.emplace_back(std::make_unique<os_task>([&read_lines, r]() { read_lines(r); }, "reader", 512, 1));
+
+    // The feeder works as the RX ISR (or the DMA) driven by the UART.
+    auto bytes_per_tick = std::max<size_t>(1, config.baud / 10 / configTICK_RATE_HZ);
+    for (size_t pos = 0, num_fed_this_tick = 0; pos < stream.size();)
+    {
+        while (is_rx_stopped)
+            taskYIELD();
+
+        auto n = std::min(config.burst, stream.size() - pos);
+        rx_burst = std::string_view{stream.data() + pos, n};
+        pos += n;
+        // The line is complete once its terminator is received.
+        auto now = bench_clock::now();
+        bool is_any_line_complete = false;
+        for (auto end_pos = pos - n; end_pos < pos; ++end_pos)
+        {
+            if ((end_pos + 1) % config.line_len == 0)
+            {
+                line_completion_times[end_pos / config.line_len] = now;
+                is_any_line_complete = true;
+            }
+        }
+        std::raise(SIGNAL_RX);
+
+        if (config.baud != 0 && (num_fed_this_tick += n) >= bytes_per_tick)
+        {
+            num_fed_this_tick = 0;
+            vTaskDelay(1);
+        }
+        else if (config.baud == 0 && is_any_line_complete)
+        {
+            taskYIELD();
+        }
+    }
+    is_feeding_done = true;
+    for (auto &done : readers_done)
+        done.wait_set();
+    readers.clear();
+
+    std::vector<double> all_latencies;
+    for (auto &l : latencies_us)
+        all_latencies.insert(all_latencies.end(), l.begin(), l.end());
+    std::sort(all_latencies.begin(), all_latencies.end());
+    auto end = *std::max_element(reader_end_times.begin(), reader_end_times.end());
+    auto elapsed = std::chrono::duration<double>(end - start).count();
+    auto num_lines_read = all_latencies.size();
+    auto stats = chardrv.rx_stats();
+
+    std::printf("{\"bench\":\"rx\",\"rx_buf_size\":%u,\"max_num_lines\":%u,\"line_len\":%zu,\"burst\":%zu,"
+                "\"baud\":%u,\"readers\":%u,\"lines\":%zu,\"dropped_lines\":%zu,\"dropped_bytes\":%zu,"
+                "\"bytes_per_s\":%.0f,\"lines_per_s\":%.0f,\"readline_p50_us\":%.1f,\"readline_p99_us\":%.1f}\n",
+                BENCH_RX_BUF_SIZE,
+                BENCH_MAX_NUM_LINES,
+                config.line_len,
+                config.burst,
+                config.baud,
+                config.num_readers,
+                num_lines_read,
+                stats.num_dropped_lines,
+                stats.num_dropped_bytes,
+                num_lines_read * config.line_len / elapsed,
+                num_lines_read / elapsed,
+                percentile(all_latencies, 0.5),
+                percentile(all_latencies, 0.99));
+    std::fflush(stdout);
+}
+
+static void bench_tx()
+{
+    bench_char_driver chardrv{tx_it_enable, tx_it_disable, it_enable_disable, it_enable_disable, byte_send};
+    driver = &chardrv;
+    num_tx_bytes = 0;
+
+    auto stream = make_stream(config.num_lines, config.line_len);
+    auto num_lines_per_writer = config.num_lines / config.num_writers;
+    std::vector<os_flag> writers_done(config.num_writers);
+
+    auto write_lines = [&](unsigned w) {
+        for (size_t i = w * num_lines_per_writer; i < (w + 1) * num_lines_per_writer; ++i)
+            chardrv.write(std::string_view{stream.data() + i * config.line_len, config.line_len});
+        writers_done[w].set();
+    };
+
+    auto start = bench_clock::now();
+    std::vector<std::unique_ptr<os_task>> writers;
+    for (unsigned w = 0; w < config.num_writers; ++w)
+        writers.emplace_back(std::make_unique<os_task>([&write_lines, w]() { write_lines(w); }, "writer", 512, 1));
+    for (auto &done : writers_done)
+        done.wait_set();
+    auto elapsed = seconds_since(start);
+    writers.clear();
+
+    std::printf("{\"bench\":\"tx\",\"line_len\":%zu,\"writers\":%u,\"lines\":%zu,\"bytes\":%zu,\"bytes_per_s\":%.0f,"
+                "\"lines_per_s\":%.0f}\n",
+                config.line_len,
+                config.num_writers,
+                num_lines_per_writer * config.num_writers,
+                num_tx_bytes,
+                num_tx_bytes / elapsed,
+                num_lines_per_writer * config.num_writers / elapsed);
+    std::fflush(stdout);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PRIVATE FUNCTIONS
+// --------------------------------------------------------------------------------------------------------------------
+static void parse_args(int argc, char **argv)
+{
+    for (int i = 1; i < argc; ++i)
+    {
+        std::string_view arg{argv[i]};
+        auto eq = arg.find('=');
+        auto name = arg.substr(0, eq);
+        auto value = eq == std::string_view::npos ? 0 : std::strtoul(argv[i] + eq + 1, nullptr, 10);
+        if (name == "--lines")
+            config.num_lines = value;
+        else if (name == "--line-len")
+            config.line_len = value;
+        else if (name == "--burst")
+            config.burst = value;
+        else if (name == "--baud")
+            config.baud = value;
+        else if (name == "--readers")
+            config.num_readers = value;
+        else if (name == "--writers")
+            config.num_writers = value;
+        else
+            std::fprintf(stderr, "Unknown argument: %s\n", argv[i]);
+    }
+
+    // The line must be able to hold the sequence number and the terminator.
+    config.line_len = std::max<size_t>(config.line_len, 10);
+    config.burst = std::max<size_t>(config.burst, 1);
+    config.num_readers = std::max(config.num_readers, 1u);
+    config.num_writers = std::max(config.num_writers, 1u);
+}
+
+static std::string make_stream(size_t num_lines, size_t line_len)
+{
+    std::string stream(num_lines * line_len, 'x');
+    for (size_t i = 0; i < num_lines; ++i)
+    {
+        auto line = &stream[i * line_len];
+        std::snprintf(line, line_len, "%08zu", i);
+        line[8] = 'x';
+        line[line_len - 1] = '\n';
+    }
+    return stream;
+}
+
+static double percentile(std::vector<double> &sorted, double p)
+{
+    if (sorted.empty())
+        return 0;
+    return sorted[static_cast<size_t>(p * (sorted.size() - 1))];
+}
+
+static double seconds_since(bench_clock::time_point start)
+{
+    return std::chrono::duration<double>(bench_clock::now() - start).count();
+}
+
+static void tx_isr_handler_callback(int signal)
+{
+    driver->tx_isr_handler();
+    if (is_tx_it_enabled)
+        std::raise(SIGNAL_TX);
+}
+
+static void rx_isr_handler_callback(int signal)
+{
+    if (rx_burst.size() == 1)
+        driver->rx_isr_handler(rx_burst[0]);
+    else
+        driver->rx_isr_handler(rx_burst.data(), rx_burst.size());
+}
+
+static void tx_it_enable()
+{
+    is_tx_it_enabled = true;
+    std::raise(SIGNAL_TX);
+}
+
+static void tx_it_disable()
+{
+    is_tx_it_enabled = false;
+}
+
+static void it_enable_disable()
+{
+}
+
+static void byte_send(char c)
+{
+    ++num_tx_bytes;
+}
+
+static void rx_stop()
+{
+    is_rx_stopped = true;
+}
+
+static void rx_resume()
+{
+    is_rx_stopped = false;
+}
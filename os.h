@@ -25,6 +25,9 @@ typedef SemaphoreHandle_t os_recursive_mutex_t;
 typedef SemaphoreHandle_t os_mutex_t;
 typedef TickType_t os_tick_type_t;
 typedef TimerHandle_t os_timer_handle_t;
+typedef StackType_t os_stack_type_t;
+typedef StaticTask_t os_static_task_t;
+typedef TaskStatus_t os_task_status_t;
 
 #define os_true pdTRUE
 #define os_false pdFALSE
@@ -41,12 +44,46 @@ typedef TimerHandle_t os_timer_handle_t;
 
 #define os_task_create(code, name, stack_size, params, priority, task_handle_addr)                                     \
     xTaskCreate(code, name, stack_size, params, priority, task_handle_addr)
+#define os_task_create_static(code, name, stack_size, params, priority, stack_buffer, task_buffer)                     \
+    xTaskCreateStatic(code, name, stack_size, params, priority, stack_buffer, task_buffer)
 #define os_task_delete_this() vTaskDelete(NULL)
 #define os_task_delete(task_handle) vTaskDelete(task_handle)
 #define os_task_get_current_task_handle() xTaskGetCurrentTaskHandle()
 #define os_task_yield taskYIELD
 #define os_task_yield_from_isr portYIELD_FROM_ISR
 #define os_task_get_state(task_handle) eTaskGetState(task_handle)
+#define os_task_get_stack_high_water_mark(task_handle) uxTaskGetStackHighWaterMark(task_handle)
+#define os_get_system_state(task_statuses, max_num_tasks, total_run_time_addr)                                        \
+    uxTaskGetSystemState(task_statuses, max_num_tasks, total_run_time_addr)
+
+#if defined(configNUMBER_OF_CORES)
+#define os_num_cores configNUMBER_OF_CORES
+#elif defined(configNUM_CORES)
+#define os_num_cores configNUM_CORES
+#else
+#define os_num_cores 1
+#endif
+
+/* Core affinity is available only with the SMP kernel. Otherwise the affinity masks are accepted and ignored. */
+#if (os_num_cores > 1) && defined(configUSE_CORE_AFFINITY) && (configUSE_CORE_AFFINITY == 1)
+#define os_has_core_affinity 1
+typedef UBaseType_t os_core_affinity_mask_t;
+#define os_core_affinity_any tskNO_AFFINITY
+#define os_task_create_affinity(code, name, stack_size, params, priority, core_affinity, task_handle_addr)             \
+    xTaskCreateAffinitySet(code, name, stack_size, params, priority, core_affinity, task_handle_addr)
+#define os_task_set_core_affinity(task_handle, core_affinity) vTaskCoreAffinitySet(task_handle, core_affinity)
+#define os_task_get_core_affinity(task_handle) vTaskCoreAffinityGet(task_handle)
+#else
+#define os_has_core_affinity 0
+typedef UBaseType_t os_core_affinity_mask_t;
+#define os_core_affinity_any ((os_core_affinity_mask_t)-1)
+#define os_task_create_affinity(code, name, stack_size, params, priority, core_affinity, task_handle_addr)             \
+    ((void)(core_affinity), xTaskCreate(code, name, stack_size, params, priority, task_handle_addr))
+#define os_task_set_core_affinity(task_handle, core_affinity) ((void)(task_handle), (void)(core_affinity))
+#define os_task_get_core_affinity(task_handle) ((void)(task_handle), os_core_affinity_any)
+#endif
+#define os_core_affinity_of(core) ((os_core_affinity_mask_t)1 << (core))
+
 #define os_wait_endlessly_for_notification() ulTaskNotifyTake(pdTRUE, portMAX_DELAY)
 #define os_wait_for_notification_ms(timeout_ms) ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(timeout_ms))
 #define os_notify(task_handle) xTaskNotifyGive(task_handle)
@@ -59,12 +96,16 @@ typedef TimerHandle_t os_timer_handle_t;
 #define os_event_group_set_bits(event_group, bits_to_set) xEventGroupSetBits(event_group, bits_to_set)
 #define os_event_group_wait_bits_endlessly(event_group, bits_to_wait_for, clear_on_exit, wait_for_all)                 \
     xEventGroupWaitBits(event_group, bits_to_wait_for, clear_on_exit, wait_for_all, portMAX_DELAY)
+#define os_event_group_wait_bits(event_group, bits_to_wait_for, clear_on_exit, wait_for_all, timeout)                 \
+    xEventGroupWaitBits(event_group, bits_to_wait_for, clear_on_exit, wait_for_all, os_timeout_to_ticks(timeout))
 #define os_event_group_clear_bits(event_group, bits_to_clear) xEventGroupClearBits(event_group, bits_to_clear)
 #define os_event_group_get_bits(event_group) xEventGroupGetBits(event_group)
 #define os_counting_semaphore_create(max_count, initial_count) xSemaphoreCreateCounting(max_count, initial_count)
 #define os_counting_semaphore_delete(semaphore) vSemaphoreDelete(semaphore)
+#define os_counting_semaphore_give(semaphore) xSemaphoreGive(semaphore)
 #define os_counting_semaphore_give_from_isr(semaphore) os_semaphore_give_from_isr(semaphore)
 #define os_counting_semaphore_take(semaphore, timeout) xSemaphoreTake(semaphore, os_timeout_to_ticks(timeout))
+#define os_counting_semaphore_get_count(semaphore) uxSemaphoreGetCount(semaphore)
 #define os_recursive_mutex_create() xSemaphoreCreateRecursiveMutex()
 #define os_recursive_mutex_delete(mutex) vSemaphoreDelete(mutex)
 #define os_recursive_mutex_take(mutex, timeout) xSemaphoreTakeRecursive(mutex, os_timeout_to_ticks(timeout))
@@ -96,6 +137,10 @@ typedef TimerHandle_t os_timer_handle_t;
 #define os_get_minimum_ever_free_heap_size() xPortGetMinimumEverFreeHeapSize()
 
 #define os_scheduler_start() vTaskStartScheduler()
+#define os_get_tick_count() xTaskGetTickCount()
+#define os_task_delay_until(previous_wake_time_addr, period_ticks)                                                     \
+    vTaskDelayUntil(previous_wake_time_addr, period_ticks)
+#define os_delay_ticks(ticks) vTaskDelay(ticks)
 
 static inline void os_notify_from_isr(os_task_handle_t task_handle)
 {
@@ -118,12 +163,32 @@ static inline void os_semaphore_give_from_isr(os_binary_semaphore_t semaphore)
     portEND_SWITCHING_ISR(higher_prior_task_woken);
 }
 
+//! Gives the semaphore n times, but requests the context switch at most once.
+static inline void os_counting_semaphore_give_n_from_isr(os_counting_semaphore_t semaphore, unsigned n)
+{
+    BaseType_t higher_prior_task_woken = pdFALSE;
+    while (n-- > 0)
+        xSemaphoreGiveFromISR(semaphore, &higher_prior_task_woken);
+    portEND_SWITCHING_ISR(higher_prior_task_woken);
+}
+
 static inline void os_delay_ms(unsigned timeout)
 {
     TickType_t t = os_timeout_to_ticks(timeout);
     vTaskDelay(t);
 }
 
+//! Returns the run time stats counter when configGENERATE_RUN_TIME_STATS is enabled and the tick count otherwise.
+//! Callable from both a task and an ISR.
+static inline uint32_t os_timestamp(void)
+{
+#if configGENERATE_RUN_TIME_STATS == 1
+    return portGET_RUN_TIME_COUNTER_VALUE();
+#else
+    return xTaskGetTickCountFromISR();
+#endif
+}
+
 #elif defined(__MBED__)
 
 #include "mbed.h"
@@ -143,6 +208,10 @@ typedef unsigned os_recursive_mutex_t;
 typedef unsigned os_mutex_t;
 typedef unsigned os_tick_type_t;
 typedef unsigned os_timer_handle_t;
+typedef unsigned os_stack_type_t;
+typedef unsigned os_static_task_t;
+typedef unsigned os_task_status_t;
+typedef unsigned os_core_affinity_mask_t;
 
 #define os_true 1
 #define os_false 0
@@ -158,6 +227,7 @@ typedef unsigned os_timer_handle_t;
 #define os_task_state_deleted 0
 
 #define os_task_create(code, name, stack_size, params, priority, task_handle_addr) empty_fun(0)
+#define os_task_create_static(code, name, stack_size, params, priority, stack_buffer, task_buffer) empty_fun(0)
 #define os_task_delete(task_handle) empty_fun(0)
 #define os_task_get_current_task_handle() empty_fun(0)
 #define os_wait_endlessly_for_notification() empty_fun(0)
@@ -171,10 +241,20 @@ typedef unsigned os_timer_handle_t;
 #define os_task_yield() empty_fun(0)
 #define os_task_yield_from_isr() empty_fun(0)
 #define os_task_get_state(task_handle) empty_fun(0)
+#define os_task_get_stack_high_water_mark(task_handle) empty_fun(0)
+#define os_get_system_state(task_statuses, max_num_tasks, total_run_time_addr) empty_fun(0)
+#define os_num_cores 1
+#define os_has_core_affinity 0
+#define os_core_affinity_any ((os_core_affinity_mask_t)-1)
+#define os_core_affinity_of(core) ((os_core_affinity_mask_t)1 << (core))
+#define os_task_create_affinity(code, name, stack_size, params, priority, core_affinity, task_handle_addr) empty_fun(0)
+#define os_task_set_core_affinity(task_handle, core_affinity) empty_fun(0)
+#define os_task_get_core_affinity(task_handle) empty_fun(0)
 #define os_event_group_create() empty_fun(0)
 #define os_event_group_delete(event_group) empty_fun(0)
 #define os_event_group_set_bits(event_group, bits_to_set) empty_fun(0)
 #define os_event_group_wait_bits_endlessly(event_group, bits_to_wait_for, clear_on_exit, wait_for_all) empty_fun(0)
+#define os_event_group_wait_bits(event_group, bits_to_wait_for, clear_on_exit, wait_for_all, timeout) empty_fun(0)
 #define os_event_group_clear_bits(event_group, bits_to_clear) empty_fun(0)
 #define os_event_group_set_bits_from_isr(event_group, bits_to_set) empty_fun(0)
 #define os_event_group_get_bits(event_group) empty_fun(0)
@@ -190,8 +270,11 @@ typedef unsigned os_timer_handle_t;
 #define os_mutex_give(mutex) empty_fun(0)
 #define os_counting_semaphore_create(max_count, initial_count) empty_fun(0)
 #define os_counting_semaphore_delete(semaphore) empty_fun(0)
+#define os_counting_semaphore_give(semaphore) empty_fun(0)
 #define os_counting_semaphore_give_from_isr(semaphore) empty_fun(0)
+#define os_counting_semaphore_give_n_from_isr(semaphore, n) empty_fun(0)
 #define os_counting_semaphore_take(semaphore, timeout) empty_fun(0)
+#define os_counting_semaphore_get_count(semaphore) empty_fun(0)
 #define os_binary_semaphore_create() empty_fun(0)
 #define os_binary_semaphore_delete(mutex) empty_fun(0)
 #define os_binary_semaphore_take(mutex, timeout) empty_fun(0)
@@ -207,6 +290,10 @@ typedef unsigned os_timer_handle_t;
 #define os_timer_change_period_and_reset(tim, new_period_ms, timeout_ms) empty_fun(0)
 #define os_timeout_to_ticks(timeout) empty_fun(0)
 #define os_scheduler_start() empty_fun(0)
+#define os_get_tick_count() empty_fun(0)
+#define os_task_delay_until(previous_wake_time_addr, period_ticks) empty_fun(0)
+#define os_delay_ticks(ticks) empty_fun(0)
+#define os_timestamp() empty_fun(0)
 
 static inline unsigned empty_fun(unsigned retval)
 {
@@ -7,9 +7,13 @@
 #ifndef OS_CHAR_DRIVER_HPP
 #define OS_CHAR_DRIVER_HPP
 
-#include "ibytestream_ostringstream.hpp"
 #include "os.h"
+#include "os_framing.hpp"
 #include "os_lockguard.hpp"
+#include "os_rx_line_buffer.hpp"
+#include "os_wait_set.hpp"
+#include <algorithm>
+#include <atomic>
 #include <functional>
 #include <string>
 #include <type_traits>
@@ -21,21 +25,86 @@ namespace jungles {
 // DECLARATIONS AND DEFINITIONS FOR PUBLIC USE
 // --------------------------------------------------------------------------------------------------------------------
 
+//! Selects the blocking write(), which streams the strings straight from the caller's memory. This is the default.
+struct os_char_driver_unbuffered_tx
+{
+};
+
+//! Tells what the buffered write() does when the data does not fit into the TX buffer.
+enum class os_char_driver_tx_full_policy
+{
+    //! Blocks until the ISR makes room for all the data.
+    block,
+    //! Writes as much as fits and drops the rest.
+    truncate,
+    //! Writes nothing when all the data does not fit.
+    fail
+};
+
+//! Selects the non-blocking write(), which copies the data to a TX ring buffer of BufSize bytes.
+template <size_t BufSize, os_char_driver_tx_full_policy FullPolicy = os_char_driver_tx_full_policy::block>
+struct os_char_driver_buffered_tx
+{
+    static_assert(BufSize > 0, "The TX buffer must be able to hold at least one byte");
+
+    static inline constexpr size_t buf_size = BufSize;
+    static inline constexpr os_char_driver_tx_full_policy full_policy = FullPolicy;
+};
+
+//! Tells how much received data has been lost.
+struct os_char_driver_rx_stats
+{
+    //! Bytes dropped because the RX buffer was full.
+    size_t num_dropped_bytes;
+    //! Lines (or frames) dropped because there was no room for them, or because they were malformed or truncated.
+    size_t num_dropped_lines;
+    //! Overruns reported by the hardware with rx_overrun_isr_handler().
+    size_t num_overruns;
+};
+
 /**
  * \brief Works similarly to linux's char driver. Allows to readlines and write strings to a device.
  *
  * This implementation assumes that it works on top of ISR handlers. Because of that RX and TX enablers/disablers must
- * be provided and also a function which allows to send a byte over the TX line. It is a wrapper over
- * jungles::ibytestream_ostringstream object used to received data (see it's documentation for details).
+ * be provided and also a function which allows to send a byte over the TX line. The received data is split into lines
+ * by jungles::os_rx_line_buffer (see it's documentation for details).
  * This class performs also a blocking write to make it possibly most memory effective - the strings passed to the
  * write() function are not copied to any internal buffer - they'ra streamed from the caller side.
  * The tx_isr_handler and rx_isr_handler must be called from ISR to make this class work as expected.
+ * The RX and TX paths are independent: a task blocked in readline() does not prevent other tasks from writing.
+ *
+ * Instead of the byte sender, a chunk sender can be provided. It is given all the bytes which remain to be sent and
+ * returns how many of them it has accepted, e.g. filled a hardware FIFO with or started a DMA transfer of. The TX ISR
+ * (or the DMA transfer complete ISR) shall then call tx_isr_handler() again, the same way as in the byte mode. The
+ * accepted bytes must stay untouched until then, so in the buffered mode they are given back to write() only on that
+ * call.
+ *
+ * When TxMode is os_char_driver_buffered_tx, write() copies the data to an internal TX ring buffer and returns
+ * without waiting for the transmission, which is then driven by the TX ISR. flush() awaits the end of the
+ * transmission.
+ *
+ * When Framing is a binary framing (e.g. os_slip_framing or os_cobs_framing), the received bytes are decoded in the
+ * ISR and the frames are stored in the RX buffer instead of lines. They are read with read_frame() and sent with
+ * write_frame(), which encodes them on the fly. The RX exceptional chars and terminators are then ignored.
+ *
+ * Lost RX data is accounted in rx_stats(). To avoid the loss, RX flow control can be enabled: the RX stopper is
+ * called from the RX ISR when the RX buffer fills up above the high watermark (or when there is no room for another
+ * line) and the RX resumer is called by the reader once the buffer drains below the low watermark. The callbacks can
+ * e.g. deassert/assert RTS or put XOFF/XON to the transmitter.
+ *
+ * The driver can be added to an os_wait_set, so that a single task can serve many drivers (see os_line_dispatcher)
+ * instead of keeping a task blocked in readline() per driver.
  */
-template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf> class os_char_driver
+template <size_t InternalRxBufSize,
+          size_t MaxNumStringsInRxBuf,
+          typename TxMode = os_char_driver_unbuffered_tx,
+          typename Framing = os_line_framing>
+class os_char_driver
 {
   public:
     using PtrToVoidFunTakingVoid = void (*)(void);
     using PtrToVoidFunTakingChar = void (*)(char);
+    using PtrToSizeFunTakingChunk = size_t (*)(const char *, size_t);
 
     explicit os_char_driver(PtrToVoidFunTakingVoid tx_it_enabler,
                             PtrToVoidFunTakingVoid tx_it_disabler,
@@ -45,18 +114,105 @@ template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf> class os_char_d
                             std::string_view rx_exceptional_chars = std::string_view{""},
                             std::string_view rx_string_terminators = std::string_view{"\0\r\n", 3});
 
+    explicit os_char_driver(PtrToVoidFunTakingVoid tx_it_enabler,
+                            PtrToVoidFunTakingVoid tx_it_disabler,
+                            PtrToVoidFunTakingVoid rx_it_enabler,
+                            PtrToVoidFunTakingVoid rx_it_disabler,
+                            PtrToSizeFunTakingChunk chunk_sender,
+                            std::string_view rx_exceptional_chars = std::string_view{""},
+                            std::string_view rx_string_terminators = std::string_view{"\0\r\n", 3});
+
     ~os_char_driver();
 
     /**
-     * \brief Blocking write multiple strings.
+     * \brief Write multiple strings.
+     *
+     * In the unbuffered mode it blocks until all the strings are sent. In the buffered mode it blocks only when
+     * the data does not fit into the TX buffer and the full buffer policy is os_char_driver_tx_full_policy::block.
+     *
      * \param[in] Can be vectors, arrays, string_views ... - underlying char array must occupy contiguous memory.
+     * \returns The number of bytes written (or copied to the TX buffer).
      */
-    template <typename... StringTypes> void write(StringTypes &&... strings);
+    template <typename... StringTypes> size_t write(StringTypes &&... strings);
     std::string readline(unsigned timeout_ms);
 
+    /**
+     * \brief Reads a line to the caller's buffer without any heap allocation.
+     *
+     * When the line is longer than the buffer, the rest of the line is discarded. The line is not null-terminated.
+     *
+     * \returns The number of bytes read to the buffer, zero on timeout.
+     */
+    size_t readline(char *buf, size_t buf_size, unsigned timeout_ms);
+
+    /**
+     * \brief Reads a decoded frame to the caller's buffer. Works like readline(char *, size_t, unsigned).
+     *
+     * \returns The number of bytes read to the buffer, zero on timeout. Empty frames are never received.
+     */
+    template <typename Fr = Framing, class = typename std::enable_if_t<!std::is_same_v<Fr, os_line_framing>>>
+    size_t read_frame(char *buf, size_t buf_size, unsigned timeout_ms);
+
+    /**
+     * \brief Encodes the payload as a single frame and writes it.
+     *
+     * Blocks like write(). In the buffered mode with a non-blocking full buffer policy, the frame is written only when
+     * all of it fits into the TX buffer, as a part of a frame would be useless for the peer.
+     *
+     * \param[in] payload Can be a vector, an array, a string_view ... - must occupy contiguous memory.
+     * \returns True when the frame has been written, false otherwise.
+     */
+    template <typename Payload,
+              typename Fr = Framing,
+              class = typename std::enable_if_t<!std::is_same_v<Fr, os_line_framing>>>
+    bool write_frame(Payload &&payload);
+
+    //! Awaits until all the buffered data is handed to the hardware, including the ISR's call back after the last
+    //! chunk. Returns false on timeout.
+    template <typename Mode = TxMode,
+              class = typename std::enable_if_t<!std::is_same_v<Mode, os_char_driver_unbuffered_tx>>>
+    bool flush(unsigned timeout_ms);
+
+    /**
+     * \brief Enables RX flow control driven by the RX buffer fill level. Shall be called before the reception starts.
+     *
+     * \param[in] high_watermark Number of the buffered bytes at which the reception is stopped. The bytes which arrive
+     *      after that must fit into the rest of the buffer, e.g. the ones in the UART's FIFO.
+     * \param[in] low_watermark Number of the buffered bytes at which the reception is resumed. Must be lower than the
+     *      high watermark.
+     */
+    void enable_rx_flow_control(PtrToVoidFunTakingVoid rx_stopper,
+                                PtrToVoidFunTakingVoid rx_resumer,
+                                size_t high_watermark,
+                                size_t low_watermark);
+
+    os_char_driver_rx_stats rx_stats() const;
+
+    /**
+     * \brief Returns true when a complete line has been received and no reader has reserved it yet. Used by
+     * os_wait_set.
+     *
+     * A line taken by a reader which hasn't popped it yet is not reported, so that the other readers block instead of
+     * spinning until it is popped.
+     */
+    bool is_ready();
+
+    //! Makes the driver notify the listener on each line received. Used by os_wait_set.
+    void attach_listener(os_wait_set_listener *listener);
+
     void tx_isr_handler();
     void rx_isr_handler(char c);
 
+    /**
+     * \brief Handles a burst of received bytes, e.g. on DMA half/full transfer or on UART idle line interrupt.
+     *
+     * The readers are woken up once for all the lines completed by the burst, instead of once per line.
+     */
+    void rx_isr_handler(const char *data, size_t len);
+
+    //! Shall be called from ISR when the hardware reports an RX overrun.
+    void rx_overrun_isr_handler();
+
     // ----------------------------------------------------------------------------------------------------------------
     // DECLARATIONS AND DEFINITIONS FOR PRIVATE USE
     // ----------------------------------------------------------------------------------------------------------------
@@ -64,6 +220,51 @@ template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf> class os_char_d
     struct events
     {
         static inline constexpr unsigned tx_end = 1;
+        static inline constexpr unsigned tx_space = 2;
+    };
+
+    static inline constexpr bool is_tx_buffered = !std::is_same_v<TxMode, os_char_driver_unbuffered_tx>;
+
+    //! Size of the stack chunk in which write_frame() gathers the short encoded parts in the unbuffered mode.
+    static inline constexpr size_t tx_frame_chunk_size = 32;
+
+    //! Ring buffer filled by write() and drained by the TX ISR, used in the buffered mode.
+    struct tx_ring
+    {
+        //! The indices run over 2 * size values, so that a full buffer can be distinguished from an empty one.
+        static inline constexpr size_t size = TxMode::buf_size;
+        static inline constexpr size_t index_range = 2 * size;
+
+        char buf[size];
+        //! Written only by the TX ISR.
+        std::atomic<size_t> head{0};
+        //! Written only by write().
+        std::atomic<size_t> tail{0};
+        //! Set by write() before it blocks on the full buffer.
+        std::atomic<bool> writer_waiting{false};
+        //! Bytes accepted by the chunk sender, which stay in the buffer until the TX ISR calls back. Used only by the
+        //! TX ISR.
+        size_t num_in_flight{0};
+
+        static size_t num_used(size_t head, size_t tail)
+        {
+            return tail >= head ? tail - head : index_range - head + tail;
+        }
+
+        static size_t advance(size_t idx, size_t n)
+        {
+            idx += n;
+            return idx >= index_range ? idx - index_range : idx;
+        }
+
+        static size_t offset(size_t idx)
+        {
+            return idx < size ? idx : idx - size;
+        }
+    };
+
+    struct no_tx_ring
+    {
     };
 
     const PtrToVoidFunTakingVoid m_tx_it_enabler;
@@ -71,93 +272,340 @@ template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf> class os_char_d
     const PtrToVoidFunTakingVoid m_rx_it_enabler;
     const PtrToVoidFunTakingVoid m_rx_it_disabler;
     const PtrToVoidFunTakingChar m_byte_sender;
+    const PtrToSizeFunTakingChunk m_chunk_sender;
 
-    ibytestream_ostringstream<InternalRxBufSize, MaxNumStringsInRxBuf> m_rx_stream;
+    os_rx_line_buffer<InternalRxBufSize, MaxNumStringsInRxBuf, Framing> m_rx_stream;
     os_counting_semaphore_t m_rx_msgs_counting_sem;
-    os_mutex_t m_mux;
+    //! Serializes the readers only while a line is being popped, never while awaiting it.
+    os_mutex_t m_rx_mux;
+    //! Serializes the writers.
+    os_mutex_t m_tx_mux;
     os_event_group_handle_t m_events;
     std::pair<const char *, const char *> transmitted_string;
+    std::conditional_t<is_tx_buffered, tx_ring, no_tx_ring> m_tx_ring;
 
+    //! Listener of the os_wait_set the driver belongs to, if any.
+    std::atomic<os_wait_set_listener *> m_rx_listener{nullptr};
+
+    PtrToVoidFunTakingVoid m_rx_stopper{nullptr};
+    PtrToVoidFunTakingVoid m_rx_resumer{nullptr};
+    size_t m_rx_high_watermark{InternalRxBufSize};
+    size_t m_rx_low_watermark{0};
+    std::atomic<bool> m_is_rx_stopped{false};
+
+    std::atomic<size_t> m_num_rx_overruns{0};
+
+    static Framing make_framing(std::string_view rx_exceptional_chars, std::string_view rx_string_terminators);
+
+    template <typename... StringTypes> size_t write_unlocked(StringTypes &&... strings);
     template <typename StringType> void write_single_string(StringType &&string);
+    size_t write_buffered(const char *data, size_t len);
+    void notify_rx_listener_from_isr();
+    void stop_rx_if_above_high_watermark();
+    void resume_rx_if_below_low_watermark();
+    void tx_isr_handler_buffered();
+    size_t release_tx_bytes_from_isr(size_t head, size_t num_bytes);
 };
 
 // --------------------------------------------------------------------------------------------------------------------
 // PUBLIC MEMBERS' DEFINITIONS
 // --------------------------------------------------------------------------------------------------------------------
-template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf>
-os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf>::os_char_driver(PtrToVoidFunTakingVoid tx_it_enabler,
-                                                                        PtrToVoidFunTakingVoid tx_it_disabler,
-                                                                        PtrToVoidFunTakingVoid rx_it_enabler,
-                                                                        PtrToVoidFunTakingVoid rx_it_disabler,
-                                                                        PtrToVoidFunTakingChar byte_sender,
-                                                                        std::string_view rx_exceptional_chars,
-                                                                        std::string_view rx_string_terminators)
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::os_char_driver(
+    PtrToVoidFunTakingVoid tx_it_enabler,
+    PtrToVoidFunTakingVoid tx_it_disabler,
+    PtrToVoidFunTakingVoid rx_it_enabler,
+    PtrToVoidFunTakingVoid rx_it_disabler,
+    PtrToVoidFunTakingChar byte_sender,
+    std::string_view rx_exceptional_chars,
+    std::string_view rx_string_terminators)
+    : m_tx_it_enabler{tx_it_enabler}, m_tx_it_disabler{tx_it_disabler}, m_rx_it_enabler{rx_it_enabler},
+      m_rx_it_disabler{rx_it_disabler}, m_byte_sender{byte_sender}, m_chunk_sender{nullptr},
+      m_rx_stream{make_framing(rx_exceptional_chars, rx_string_terminators)},
+      m_rx_msgs_counting_sem{os_counting_semaphore_create(MaxNumStringsInRxBuf, 0)}, m_rx_mux{os_mutex_create()},
+      m_tx_mux{os_mutex_create()}, m_events{os_event_group_create()}
+{
+    (*m_rx_it_enabler)();
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::os_char_driver(
+    PtrToVoidFunTakingVoid tx_it_enabler,
+    PtrToVoidFunTakingVoid tx_it_disabler,
+    PtrToVoidFunTakingVoid rx_it_enabler,
+    PtrToVoidFunTakingVoid rx_it_disabler,
+    PtrToSizeFunTakingChunk chunk_sender,
+    std::string_view rx_exceptional_chars,
+    std::string_view rx_string_terminators)
     : m_tx_it_enabler{tx_it_enabler}, m_tx_it_disabler{tx_it_disabler}, m_rx_it_enabler{rx_it_enabler},
-      m_rx_it_disabler{rx_it_disabler}, m_byte_sender{byte_sender}, m_rx_stream{rx_exceptional_chars,
-                                                                                rx_string_terminators},
-      m_rx_msgs_counting_sem{os_counting_semaphore_create(MaxNumStringsInRxBuf * 2, 0)}, m_mux{os_mutex_create()},
-      m_events{os_event_group_create()}
+      m_rx_it_disabler{rx_it_disabler}, m_byte_sender{nullptr}, m_chunk_sender{chunk_sender},
+      m_rx_stream{make_framing(rx_exceptional_chars, rx_string_terminators)},
+      m_rx_msgs_counting_sem{os_counting_semaphore_create(MaxNumStringsInRxBuf, 0)}, m_rx_mux{os_mutex_create()},
+      m_tx_mux{os_mutex_create()}, m_events{os_event_group_create()}
 {
     (*m_rx_it_enabler)();
 }
 
-template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf>
-os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf>::~os_char_driver()
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::~os_char_driver()
 {
     (*m_rx_it_disabler)();
     (*m_tx_it_disabler)();
     os_counting_semaphore_delete(m_rx_msgs_counting_sem);
-    os_mutex_delete(m_mux);
+    os_mutex_delete(m_rx_mux);
+    os_mutex_delete(m_tx_mux);
     os_event_group_delete(m_events);
 }
 
-template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf>
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
 template <typename... StringTypes>
-void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf>::write(StringTypes &&... strings)
+size_t os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::write(StringTypes &&... strings)
 {
-    os_lockguard g{m_mux};
-    (write_single_string(strings), ...);
+    os_lockguard g{m_tx_mux};
+    return write_unlocked(strings...);
 }
 
-template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf>
-std::string os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf>::readline(unsigned timeout_ms)
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+template <typename Payload, typename Fr, class>
+bool os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::write_frame(Payload &&payload)
 {
-    os_lockguard g{m_mux};
-    auto tmt = os_timeout_to_ticks(timeout_ms);
-    if (os_counting_semaphore_take(m_rx_msgs_counting_sem, tmt) == os_true)
-        return m_rx_stream.pop_string();
+    auto data = &(*std::begin(payload));
+    auto len = static_cast<size_t>(std::distance(std::begin(payload), std::end(payload)));
+
+    os_lockguard g{m_tx_mux};
+    if constexpr (is_tx_buffered)
+    {
+        if constexpr (TxMode::full_policy != os_char_driver_tx_full_policy::block)
+        {
+            size_t encoded_len = 0;
+            Framing::encode(data, len, [&encoded_len](const char *, size_t n) { encoded_len += n; });
+            if (encoded_len > tx_ring::size - tx_ring::num_used(m_tx_ring.head.load(), m_tx_ring.tail.load()))
+                return false;
+        }
+
+        // The parts are only copied to the TX buffer, so they are written as they are.
+        Framing::encode(data, len, [this](const char *part, size_t n) { write_unlocked(std::string_view{part, n}); });
+    }
     else
+    {
+        // Each write blocks for a TX round-trip, so the short parts, e.g. the escape sequences and the code bytes, are
+        // gathered in a chunk. The parts which are at least as long as the chunk are streamed from the payload.
+        char chunk[tx_frame_chunk_size];
+        size_t chunk_len = 0;
+        auto write_chunk = [this, &chunk, &chunk_len]() {
+            if (chunk_len > 0)
+                write_single_string(std::string_view{chunk, chunk_len});
+            chunk_len = 0;
+        };
+        Framing::encode(data, len, [this, &chunk, &chunk_len, &write_chunk](const char *part, size_t n) {
+            if (chunk_len + n > tx_frame_chunk_size)
+                write_chunk();
+            if (n >= tx_frame_chunk_size)
+            {
+                write_single_string(std::string_view{part, n});
+                return;
+            }
+            std::copy_n(part, n, chunk + chunk_len);
+            chunk_len += n;
+        });
+        write_chunk();
+    }
+    return true;
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+template <typename Fr, class>
+size_t os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::read_frame(char *buf,
+                                                                                            size_t buf_size,
+                                                                                            unsigned timeout_ms)
+{
+    return readline(buf, buf_size, timeout_ms);
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+template <typename Mode, class>
+bool os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::flush(unsigned timeout_ms)
+{
+    // The bit is cleared before the buffer is checked, so that the ISR draining the buffer in the meantime is not
+    // missed.
+    os_event_group_clear_bits(m_events, events::tx_end);
+    if (m_tx_ring.head.load() == m_tx_ring.tail.load())
+        return true;
+    return os_event_group_wait_bits(m_events, events::tx_end, os_true, os_true, timeout_ms) & events::tx_end;
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+std::string os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::readline(unsigned timeout_ms)
+{
+    // Each count of the semaphore stands for one line, so the line is reserved for this reader once the semaphore is
+    // taken. The lock is held only to pop the line, thus the readers do not block the writers nor each other.
+    auto tmt = os_timeout_to_ticks(timeout_ms);
+    if (os_counting_semaphore_take(m_rx_msgs_counting_sem, tmt) == os_false)
         return "";
+
+    os_lockguard g{m_rx_mux};
+    auto line = m_rx_stream.pop_string();
+    resume_rx_if_below_low_watermark();
+    return line;
 }
 
-template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf>
-void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf>::tx_isr_handler()
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+size_t os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::readline(char *buf,
+                                                                                          size_t buf_size,
+                                                                                          unsigned timeout_ms)
 {
-    auto &[beg, end] = transmitted_string;
-    if (beg == end)
+    auto tmt = os_timeout_to_ticks(timeout_ms);
+    if (os_counting_semaphore_take(m_rx_msgs_counting_sem, tmt) == os_false)
+        return 0;
+
+    os_lockguard g{m_rx_mux};
+    auto len = m_rx_stream.pop_line(buf, buf_size);
+    resume_rx_if_below_low_watermark();
+    return len;
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::enable_rx_flow_control(
+    PtrToVoidFunTakingVoid rx_stopper,
+    PtrToVoidFunTakingVoid rx_resumer,
+    size_t high_watermark,
+    size_t low_watermark)
+{
+    m_rx_high_watermark = high_watermark;
+    m_rx_low_watermark = low_watermark;
+    m_rx_resumer = rx_resumer;
+    m_rx_stopper = rx_stopper;
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+os_char_driver_rx_stats os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::rx_stats() const
+{
+    return os_char_driver_rx_stats{m_rx_stream.num_dropped_bytes(),
+                                   m_rx_stream.num_dropped_lines(),
+                                   m_num_rx_overruns.load(std::memory_order_relaxed)};
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+bool os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::is_ready()
+{
+    return os_counting_semaphore_get_count(m_rx_msgs_counting_sem) > 0;
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::attach_listener(
+    os_wait_set_listener *listener)
+{
+    m_rx_listener.store(listener);
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::tx_isr_handler()
+{
+    if constexpr (is_tx_buffered)
     {
-        os_event_group_set_bits_from_isr(m_events, events::tx_end);
-        (*m_tx_it_disabler)();
+        tx_isr_handler_buffered();
     }
     else
     {
-        (*m_byte_sender)(*beg++);
+        auto &[beg, end] = transmitted_string;
+        if (beg == end)
+        {
+            os_event_group_set_bits_from_isr(m_events, events::tx_end);
+            (*m_tx_it_disabler)();
+        }
+        else if (m_chunk_sender)
+        {
+            beg += (*m_chunk_sender)(beg, std::distance(beg, end));
+        }
+        else
+        {
+            (*m_byte_sender)(*beg++);
+        }
     }
 }
 
-template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf>
-void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf>::rx_isr_handler(char c)
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::rx_isr_handler(char c)
 {
     if (m_rx_stream.push_byte_and_is_string_end(c))
+    {
         os_counting_semaphore_give_from_isr(m_rx_msgs_counting_sem);
+        notify_rx_listener_from_isr();
+    }
+    stop_rx_if_above_high_watermark();
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::rx_isr_handler(
+    const char *data,
+    size_t len)
+{
+    if (auto num_lines = m_rx_stream.push_bytes_and_count_string_ends(data, len); num_lines > 0)
+    {
+        os_counting_semaphore_give_n_from_isr(m_rx_msgs_counting_sem, num_lines);
+        notify_rx_listener_from_isr();
+    }
+    stop_rx_if_above_high_watermark();
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::rx_overrun_isr_handler()
+{
+    m_num_rx_overruns.fetch_add(1, std::memory_order_relaxed);
 }
 
 // --------------------------------------------------------------------------------------------------------------------
 // PRIVATE MEMBERS' DEFINITIONS
 // --------------------------------------------------------------------------------------------------------------------
-template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf>
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+Framing os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::make_framing(
+    std::string_view rx_exceptional_chars,
+    std::string_view rx_string_terminators)
+{
+    if constexpr (std::is_same_v<Framing, os_line_framing>)
+        return os_line_framing{rx_exceptional_chars, rx_string_terminators};
+    else
+        return Framing();
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+template <typename... StringTypes>
+size_t os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::write_unlocked(
+    StringTypes &&... strings)
+{
+    if constexpr (is_tx_buffered)
+    {
+        if constexpr (TxMode::full_policy == os_char_driver_tx_full_policy::fail)
+        {
+            auto num_free = tx_ring::size - tx_ring::num_used(m_tx_ring.head.load(), m_tx_ring.tail.load());
+            if ((static_cast<size_t>(std::distance(std::begin(strings), std::end(strings))) + ... + 0) > num_free)
+                return 0;
+        }
+        // With the truncate policy the strings which follow a truncated one are dropped, even if the ISR has made
+        // room for them in the meantime, so that no fragment of a string is written after a cut-off one.
+        size_t num_written = 0;
+        bool is_truncated = false;
+        auto write_string = [this, &num_written, &is_truncated](auto &string) {
+            if (is_truncated)
+                return;
+            size_t len = std::distance(std::begin(string), std::end(string));
+            auto n = write_buffered(&(*std::begin(string)), len);
+            num_written += n;
+            is_truncated = n < len;
+        };
+        (write_string(strings), ...);
+        return num_written;
+    }
+    else
+    {
+        (write_single_string(strings), ...);
+        return (static_cast<size_t>(std::distance(std::begin(strings), std::end(strings))) + ... + 0);
+    }
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
 template <typename StringType>
-void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf>::write_single_string(StringType &&string)
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::write_single_string(StringType &&string)
 {
     auto &[beg, end] = transmitted_string;
     beg = &(*std::begin(string));
@@ -166,6 +614,128 @@ void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf>::write_single_strin
     os_event_group_wait_bits_endlessly(m_events, events::tx_end, os_true, os_true);
 }
 
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+size_t os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::write_buffered(
+    const char *data,
+    size_t len)
+{
+    auto &r = m_tx_ring;
+    size_t num_written = 0;
+    while (true)
+    {
+        auto tail = r.tail.load(std::memory_order_relaxed);
+        auto num_free = tx_ring::size - tx_ring::num_used(r.head.load(std::memory_order_acquire), tail);
+        auto n = std::min(num_free, len - num_written);
+
+        // The free space may wrap around the end of the buffer.
+        auto first_part = std::min(n, tx_ring::size - tx_ring::offset(tail));
+        std::copy_n(data + num_written, first_part, r.buf + tx_ring::offset(tail));
+        std::copy_n(data + num_written + first_part, n - first_part, r.buf);
+        num_written += n;
+
+        if (n > 0)
+        {
+            r.tail.store(tx_ring::advance(tail, n));
+            (*m_tx_it_enabler)();
+        }
+
+        if (num_written == len || TxMode::full_policy != os_char_driver_tx_full_policy::block)
+            return num_written;
+
+        // The flag must be visible to the ISR before the free space is checked again, otherwise the ISR could miss
+        // the writer which is going to block.
+        os_event_group_clear_bits(m_events, events::tx_space);
+        r.writer_waiting.store(true);
+        if (tx_ring::num_used(r.head.load(), r.tail.load(std::memory_order_relaxed)) == tx_ring::size)
+            os_event_group_wait_bits_endlessly(m_events, events::tx_space, os_true, os_true);
+        r.writer_waiting.store(false);
+    }
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::tx_isr_handler_buffered()
+{
+    auto &r = m_tx_ring;
+    auto head = r.head.load(std::memory_order_relaxed);
+    // The chunk accepted on the previous call may be read by a DMA transfer until now.
+    if (r.num_in_flight > 0)
+        head = release_tx_bytes_from_isr(head, std::exchange(r.num_in_flight, 0));
+
+    auto num_used = tx_ring::num_used(head, r.tail.load(std::memory_order_acquire));
+    if (num_used == 0)
+    {
+        (*m_tx_it_disabler)();
+        // write() may have filled the buffer just before the interrupt was disabled.
+        if (r.head.load(std::memory_order_relaxed) != r.tail.load())
+            (*m_tx_it_enabler)();
+        else
+            os_event_group_set_bits_from_isr(m_events, events::tx_end);
+        return;
+    }
+
+    if (m_chunk_sender)
+    {
+        // The chunk must not wrap around the end of the buffer.
+        auto contiguous = std::min(num_used, tx_ring::size - tx_ring::offset(head));
+        r.num_in_flight = (*m_chunk_sender)(r.buf + tx_ring::offset(head), contiguous);
+    }
+    else
+    {
+        // The byte is copied to the hardware, so it can be released at once.
+        (*m_byte_sender)(r.buf[tx_ring::offset(head)]);
+        release_tx_bytes_from_isr(head, 1);
+    }
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+size_t os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::release_tx_bytes_from_isr(
+    size_t head,
+    size_t num_bytes)
+{
+    auto &r = m_tx_ring;
+    head = tx_ring::advance(head, num_bytes);
+    r.head.store(head);
+    if (r.writer_waiting.exchange(false))
+        os_event_group_set_bits_from_isr(m_events, events::tx_space);
+    return head;
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::notify_rx_listener_from_isr()
+{
+    if (auto listener = m_rx_listener.load())
+        listener->notify_from_isr();
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::stop_rx_if_above_high_watermark()
+{
+    if (m_rx_stopper == nullptr || m_is_rx_stopped.load(std::memory_order_relaxed))
+        return;
+
+    if (m_rx_stream.num_used_bytes() >= m_rx_high_watermark || m_rx_stream.num_lines() == MaxNumStringsInRxBuf)
+    {
+        m_is_rx_stopped.store(true);
+        (*m_rx_stopper)();
+    }
+}
+
+template <size_t InternalRxBufSize, size_t MaxNumStringsInRxBuf, typename TxMode, typename Framing>
+void os_char_driver<InternalRxBufSize, MaxNumStringsInRxBuf, TxMode, Framing>::resume_rx_if_below_low_watermark()
+{
+    if (!m_is_rx_stopped.load())
+        return;
+
+    // The RX ISR must not stop the reception while it is being resumed, otherwise the stop could be undone.
+    (*m_rx_it_disabler)();
+    if (m_rx_stream.num_used_bytes() <= m_rx_low_watermark && m_rx_stream.num_lines() < MaxNumStringsInRxBuf)
+    {
+        m_is_rx_stopped.store(false);
+        (*m_rx_resumer)();
+    }
+    (*m_rx_it_enabler)();
+}
+
 } // namespace jungles
 
 #endif /* OS_CHAR_DRIVER_HPP */
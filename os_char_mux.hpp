@@ -0,0 +1,164 @@
+/**
+ * @file	os_char_mux.hpp
+ * @brief	Owns many char drivers and serves the lines they receive from a single task.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_CHAR_MUX_HPP
+#define OS_CHAR_MUX_HPP
+
+#include "os_char_driver.hpp"
+#include "os_function.hpp"
+#include "os_line_dispatcher.hpp"
+#include <atomic>
+#include <optional>
+#include <string_view>
+#include <utility>
+
+namespace jungles {
+
+//! Statistics of a single port of os_char_mux.
+struct os_char_mux_port_stats
+{
+    //! Lines passed to the port's handler or queue.
+    size_t num_lines;
+    //! Bytes of the lines passed to the port's handler or queue.
+    size_t num_bytes;
+    //! Lines dropped because the port's queue was full.
+    size_t num_unrouted_lines;
+    //! Received data lost by the port's driver.
+    os_char_driver_rx_stats rx;
+};
+
+/**
+ * \brief Multiplexes the RX of NumPorts char drivers, which it owns, to per-port line handlers or queues.
+ *
+ * All the ports are served by the task which calls serve(), e.g.:
+ *
+ *      while (true)
+ *          mux.serve(os_no_timeout);
+ *
+ * so a single task and stack serve all the ports, instead of a reader task per port. The ports are served in
+ * round-robin order, one line at a time, thus a busy port does not starve the others (see os_line_dispatcher).
+ * The drivers can be used for writing by any task.
+ */
+template <size_t NumPorts, typename CharDriver, size_t MaxLineLen> class os_char_mux
+{
+  public:
+    using line_handler = os_function<void(std::string_view)>;
+
+    os_char_mux() = default;
+
+    os_char_mux(const os_char_mux &) = delete;
+    os_char_mux &operator=(const os_char_mux &) = delete;
+    os_char_mux(os_char_mux &&) = delete;
+    os_char_mux &operator=(os_char_mux &&) = delete;
+
+    /**
+     * \brief Constructs the driver of the port in place and passes the lines it receives to the handler.
+     *
+     * The handler is called from the task which calls serve(). Each port can be opened only once; opening it again
+     * trips configASSERT().
+     *
+     * \returns The driver of the port.
+     */
+    template <typename... DriverArgs> CharDriver &open(size_t port, line_handler handler, DriverArgs &&... driver_args);
+
+    /**
+     * \brief Works like open(), but the lines are sent to the queue instead.
+     *
+     * The queue element must be constructible from std::string_view, e.g. std::string. A line is dropped and
+     * accounted as unrouted when the queue is full.
+     */
+    template <typename Queue, typename... DriverArgs>
+    CharDriver &open_queued(size_t port, Queue &queue, DriverArgs &&... driver_args);
+
+    //! Returns the driver of an opened port.
+    CharDriver &driver(size_t port);
+
+    //! Awaits a line on any of the ports and routes it. Returns false on timeout.
+    bool serve(unsigned timeout_ms);
+
+    os_char_mux_port_stats stats(size_t port) const;
+
+  private:
+    struct port_counters
+    {
+        std::atomic<size_t> num_lines{0};
+        std::atomic<size_t> num_bytes{0};
+        std::atomic<size_t> num_unrouted_lines{0};
+    };
+
+    //! Must outlive the dispatcher, which detaches itself from the drivers when destroyed.
+    std::optional<CharDriver> m_drivers[NumPorts];
+    port_counters m_counters[NumPorts];
+    line_handler m_handlers[NumPorts];
+    os_line_dispatcher<NumPorts, MaxLineLen> m_dispatcher;
+
+    static void count(port_counters &counters, size_t num_bytes);
+};
+
+template <size_t NumPorts, typename CharDriver, size_t MaxLineLen>
+template <typename... DriverArgs>
+CharDriver &
+os_char_mux<NumPorts, CharDriver, MaxLineLen>::open(size_t port, line_handler handler, DriverArgs &&... driver_args)
+{
+    // Reopening would destroy the driver, which stays in the dispatcher and may be in use by the serving task.
+    configASSERT(port < NumPorts && !m_drivers[port]);
+    auto &drv = m_drivers[port].emplace(std::forward<DriverArgs>(driver_args)...);
+    m_handlers[port] = std::move(handler);
+    // The handler is kept by the mux, so the one registered in the dispatcher stays small.
+    m_dispatcher.add(drv, [this, port](std::string_view line) {
+        count(m_counters[port], line.size());
+        m_handlers[port](line);
+    });
+    return drv;
+}
+
+template <size_t NumPorts, typename CharDriver, size_t MaxLineLen>
+template <typename Queue, typename... DriverArgs>
+CharDriver &os_char_mux<NumPorts, CharDriver, MaxLineLen>::open_queued(size_t port,
+                                                                      Queue &queue,
+                                                                      DriverArgs &&... driver_args)
+{
+    auto &counters = m_counters[port];
+    return open(
+        port,
+        [&counters, &queue](std::string_view line) {
+            if (!queue.send(line))
+                counters.num_unrouted_lines.fetch_add(1, std::memory_order_relaxed);
+        },
+        std::forward<DriverArgs>(driver_args)...);
+}
+
+template <size_t NumPorts, typename CharDriver, size_t MaxLineLen>
+CharDriver &os_char_mux<NumPorts, CharDriver, MaxLineLen>::driver(size_t port)
+{
+    return *m_drivers[port];
+}
+
+template <size_t NumPorts, typename CharDriver, size_t MaxLineLen>
+bool os_char_mux<NumPorts, CharDriver, MaxLineLen>::serve(unsigned timeout_ms)
+{
+    return m_dispatcher.dispatch(timeout_ms);
+}
+
+template <size_t NumPorts, typename CharDriver, size_t MaxLineLen>
+os_char_mux_port_stats os_char_mux<NumPorts, CharDriver, MaxLineLen>::stats(size_t port) const
+{
+    auto &c = m_counters[port];
+    return os_char_mux_port_stats{c.num_lines.load(std::memory_order_relaxed),
+                                  c.num_bytes.load(std::memory_order_relaxed),
+                                  c.num_unrouted_lines.load(std::memory_order_relaxed),
+                                  m_drivers[port] ? m_drivers[port]->rx_stats() : os_char_driver_rx_stats{}};
+}
+
+template <size_t NumPorts, typename CharDriver, size_t MaxLineLen>
+void os_char_mux<NumPorts, CharDriver, MaxLineLen>::count(port_counters &counters, size_t num_bytes)
+{
+    counters.num_lines.fetch_add(1, std::memory_order_relaxed);
+    counters.num_bytes.fetch_add(num_bytes, std::memory_order_relaxed);
+}
+
+} // namespace jungles
+
+#endif /* OS_CHAR_MUX_HPP */
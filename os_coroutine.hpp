@@ -0,0 +1,625 @@
+/**
+ * @file	os_coroutine.hpp
+ * @brief	Runs many coroutines on a single task.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_COROUTINE_HPP
+#define OS_COROUTINE_HPP
+
+#if !defined(__cpp_impl_coroutine)
+#error "os_coroutine.hpp requires C++20 coroutines"
+#endif
+
+#include "neither/neither.hpp"
+#include "os.h"
+#include "os_flag.hpp"
+#include "os_mpmc_queue.hpp"
+#include "os_task.hpp"
+#include "os_wait_set.hpp"
+#include <atomic>
+#include <coroutine>
+#include <cstddef>
+#include <exception>
+#include <new>
+#include <optional>
+#include <utility>
+
+namespace jungles {
+
+template <size_t MaxNumCoroutines, size_t FrameSize> class os_coroutine_scheduler;
+
+/**
+ * \brief The return type of a coroutine run by os_coroutine_scheduler.
+ *
+ * The frame of the coroutine is allocated from the scheduler, which shall be the first parameter of the coroutine:
+ *
+ *      os_coroutine handle_connection(scheduler_type &sched, connection &conn)
+ *      {
+ *          while (true)
+ *          {
+ *              auto request = co_await sched.receive(conn.requests);
+ *              ...
+ *          }
+ *      }
+ *
+ *      sched.spawn(handle_connection(sched, conn));
+ *
+ * The coroutine starts suspended and runs when spawned. When there is no space for the frame, the returned object
+ * is empty and spawn() fails.
+ */
+class os_coroutine
+{
+  public:
+    struct promise_type
+    {
+        os_coroutine get_return_object()
+        {
+            return os_coroutine{std::coroutine_handle<promise_type>::from_promise(*this)};
+        }
+
+        static os_coroutine get_return_object_on_allocation_failure()
+        {
+            return os_coroutine{nullptr};
+        }
+
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        //! The scheduler destroys the frame when the coroutine is done.
+        std::suspend_always final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void return_void()
+        {
+        }
+
+        void unhandled_exception()
+        {
+            std::terminate();
+        }
+
+        template <typename Allocator, typename... Args>
+        static void *operator new(size_t size, Allocator &allocator, Args &...) noexcept;
+
+        static void operator delete(void *frame, size_t size) noexcept;
+    };
+
+    os_coroutine(os_coroutine &&other) noexcept : m_handle{std::exchange(other.m_handle, nullptr)}
+    {
+    }
+
+    ~os_coroutine()
+    {
+        if (m_handle)
+            m_handle.destroy();
+    }
+
+    os_coroutine(const os_coroutine &) = delete;
+    os_coroutine &operator=(const os_coroutine &) = delete;
+    os_coroutine &operator=(os_coroutine &&) = delete;
+
+    //! Returns false when the frame of the coroutine could not be allocated.
+    explicit operator bool() const
+    {
+        return static_cast<bool>(m_handle);
+    }
+
+  private:
+    template <size_t MaxNumCoroutines, size_t FrameSize> friend class os_coroutine_scheduler;
+
+    //! Precedes each frame, so that the frame can be given back to the allocator it comes from.
+    struct frame_header
+    {
+        void *allocator;
+        void (*deallocate)(void *allocator, void *block);
+    };
+
+    //! Keeps the frame aligned as if it was allocated with the global operator new.
+    static constexpr size_t frame_header_size =
+        (sizeof(frame_header) + alignof(std::max_align_t) - 1) / alignof(std::max_align_t) * alignof(std::max_align_t);
+
+    explicit os_coroutine(std::coroutine_handle<promise_type> handle) : m_handle{handle}
+    {
+    }
+
+    std::coroutine_handle<> release()
+    {
+        return std::exchange(m_handle, nullptr);
+    }
+
+    std::coroutine_handle<promise_type> m_handle;
+};
+
+/**
+ * \brief Runs coroutines on a single task, so that each concurrent activity, e.g. a protocol state machine of a
+ * connection, costs a coroutine frame instead of a task and its stack.
+ *
+ * The coroutines run one at a time, until they co_await one of the awaitables returned by receive(), wait_set(),
+ * readline() or delay(). The scheduler blocks on a single os_wait_set_listener, which the awaited queues, flags and
+ * drivers notify when they might have become ready, and wakes up to resume the coroutines which can proceed. An
+ * awaitable completes immediately, without suspending, when its object is already ready. The objects are checked
+ * every time the scheduler wakes up, so the cost of a wake-up grows with the number of the suspended coroutines.
+ *
+ * The frames come from an inline pool of MaxNumCoroutines blocks of FrameSize bytes, thus the number of the coroutines
+ * is bounded and spawning never touches the heap. A frame is given back to the pool when the coroutine returns.
+ *
+ * An awaited object can't belong to an os_wait_set at the same time, because it notifies a single listener, and it must
+ * outlive the coroutines which await it. The objects awaited by the coroutines should be consumed only by the
+ * coroutines. The coroutines which haven't finished when the scheduler is destroyed are destroyed in their suspension
+ * points.
+ */
+template <size_t MaxNumCoroutines, size_t FrameSize> class os_coroutine_scheduler
+{
+    static_assert(MaxNumCoroutines > 0, "The scheduler must be able to run at least one coroutine");
+
+  public:
+    /**
+     *	\brief Creates the task which runs the coroutines.
+     *	\param[in] name				The name of the task.
+     *	\param[in] stack_size		The size of the stack of the task, shared by all the coroutines.
+     *	\param[in] priority			The priority of the task.
+     *	\param[in] core_affinity	The cores the task may run on, see os_task.
+     */
+    os_coroutine_scheduler(const char *name,
+                           unsigned short stack_size,
+                           os_base_type_t priority,
+                           os_core_affinity_mask_t core_affinity = os_core_affinity_any);
+
+    ~os_coroutine_scheduler();
+
+    os_coroutine_scheduler(const os_coroutine_scheduler &) = delete;
+    os_coroutine_scheduler &operator=(const os_coroutine_scheduler &) = delete;
+    os_coroutine_scheduler(os_coroutine_scheduler &&) = delete;
+    os_coroutine_scheduler &operator=(os_coroutine_scheduler &&) = delete;
+
+    /**
+     * \brief Makes the scheduler run the coroutine. Can be called from any task, also from a coroutine.
+     *
+     * \returns False when the coroutine is empty, because its frame couldn't be allocated.
+     */
+    bool spawn(os_coroutine coroutine);
+
+    //! Suspends the coroutine for the time given. delay(0) lets the other ready coroutines run.
+    auto delay(unsigned time_ms);
+
+    //! Awaits an element of the os_queue. Results in what os_queue::receive() returns.
+    template <typename Queue> auto receive(Queue &queue, unsigned timeout_ms = os_no_timeout);
+
+    //! Awaits the flag to be set. Results in false on timeout.
+    auto wait_set(os_flag &flag, unsigned timeout_ms = os_no_timeout);
+
+    /**
+     * \brief Awaits a line from os_char_driver. Results in the number of bytes read to the buffer, zero on timeout.
+     *
+     * A line taken by another reader of the driver doesn't end the wait; the coroutine waits for the next line until
+     * the timeout.
+     */
+    template <typename CharDriver>
+    auto readline(CharDriver &driver, char *buf, size_t buf_size, unsigned timeout_ms = os_no_timeout);
+
+    //! Used by os_coroutine to allocate the frames. Returns nullptr when there is no space left.
+    void *allocate_frame(size_t size);
+
+    //! Used by os_coroutine to give back the frames.
+    void deallocate_frame(void *block);
+
+  private:
+    //! The object a coroutine is suspended on.
+    struct waitable
+    {
+        void *object;
+        void (*attach_listener)(void *object, os_wait_set_listener *listener);
+    };
+
+    struct waiter
+    {
+        std::coroutine_handle<> coroutine;
+        //! The awaitable, which lives in the frame of the coroutine.
+        void *awaitable;
+        //! Returns true when the coroutine can be resumed.
+        bool (*try_complete)(void *awaitable, bool is_timed_out);
+        waitable object;
+        os_tick_type_t start;
+        os_tick_type_t timeout;
+    };
+
+    /**
+     * \brief The awaitable of an operation, which tries to complete the operation with:
+     *
+     *      bool operator()(std::optional<Result> &result, bool is_timed_out);
+     *
+     * It returns true and sets the result when the operation is completed; also on timeout.
+     */
+    template <typename Result, typename Operation> class awaitable
+    {
+      public:
+        awaitable(os_coroutine_scheduler &scheduler, waitable object, unsigned timeout_ms, Operation operation)
+            : m_scheduler{scheduler},
+              m_object{object},
+              m_timeout{os_timeout_to_ticks(timeout_ms)},
+              m_operation{std::move(operation)}
+        {
+        }
+
+        bool await_ready()
+        {
+            return m_operation(m_result, false);
+        }
+
+        void await_suspend(std::coroutine_handle<> coroutine)
+        {
+            m_scheduler.suspend(waiter{coroutine, this, &try_complete, m_object, os_get_tick_count(), m_timeout});
+        }
+
+        Result await_resume()
+        {
+            return std::move(*m_result);
+        }
+
+      private:
+        static bool try_complete(void *self, bool is_timed_out)
+        {
+            auto a = static_cast<awaitable *>(self);
+            return a->m_operation(a->m_result, is_timed_out);
+        }
+
+        os_coroutine_scheduler &m_scheduler;
+        waitable m_object;
+        os_tick_type_t m_timeout;
+        Operation m_operation;
+        std::optional<Result> m_result;
+    };
+
+    template <typename Result, typename Operation>
+    awaitable<Result, Operation> make_awaitable(waitable object, unsigned timeout_ms, Operation operation);
+
+    template <typename Waitable> static waitable make_waitable(Waitable &object);
+
+    //! The queues of the handles and of the free frames must be powers of two, see os_mpmc_queue.
+    static constexpr size_t queue_size()
+    {
+        size_t size = 2;
+        while (size < MaxNumCoroutines)
+            size *= 2;
+        return size;
+    }
+
+    struct alignas(std::max_align_t) frame_block
+    {
+        unsigned char storage[os_coroutine::frame_header_size + FrameSize];
+    };
+
+    //! Body of the task.
+    void run();
+
+    //! Called from the awaitables, which are about to suspend the coroutine.
+    void suspend(const waiter &w);
+
+    //! Moves the spawned coroutines and the coroutines which can proceed to the ready ones.
+    void collect_ready();
+    void collect_spawned();
+
+    //! Blocks until an awaited object notifies the scheduler, a coroutine is spawned or the nearest timeout occurs.
+    void wait_for_ready();
+
+    //! Returns the time to the nearest timeout.
+    os_tick_type_t nearest_timeout() const;
+
+    void make_ready(std::coroutine_handle<> coroutine);
+    std::coroutine_handle<> take_ready();
+    void remove_waiter(size_t idx);
+    void destroy_coroutines();
+
+    frame_block m_frames[MaxNumCoroutines];
+    os_mpmc_queue<size_t, queue_size()> m_free_frames;
+
+    os_mpmc_queue<std::coroutine_handle<>, queue_size()> m_spawned;
+
+    //! The ring of the coroutines to be resumed; touched only by the task.
+    std::coroutine_handle<> m_ready[MaxNumCoroutines];
+    size_t m_ready_head{0};
+    size_t m_num_ready{0};
+
+    waiter m_waiters[MaxNumCoroutines];
+    size_t m_num_waiters{0};
+
+    os_wait_set_listener m_listener;
+    std::atomic<bool> m_is_stopping{false};
+    //! Given by the task when it has stopped on destruction.
+    os_binary_semaphore_t m_stopped_sem;
+
+    //! Constructed last, because the task starts running immediately.
+    os_task m_task;
+};
+
+template <typename Allocator, typename... Args>
+void *os_coroutine::promise_type::operator new(size_t size, Allocator &allocator, Args &...) noexcept
+{
+    auto block = allocator.allocate_frame(frame_header_size + size);
+    if (block == nullptr)
+        return nullptr;
+
+    new (block) frame_header{&allocator, [](void *allocator, void *block) {
+                                 static_cast<Allocator *>(allocator)->deallocate_frame(block);
+                             }};
+    return static_cast<unsigned char *>(block) + frame_header_size;
+}
+
+inline void os_coroutine::promise_type::operator delete(void *frame, size_t) noexcept
+{
+    auto block = static_cast<unsigned char *>(frame) - frame_header_size;
+    auto header = reinterpret_cast<frame_header *>(block);
+    header->deallocate(header->allocator, block);
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::os_coroutine_scheduler(const char *name,
+                                                                            unsigned short stack_size,
+                                                                            os_base_type_t priority,
+                                                                            os_core_affinity_mask_t core_affinity)
+    : m_stopped_sem{os_binary_semaphore_create()},
+      m_task([this]() { run(); }, name, stack_size, priority, core_affinity)
+{
+    for (size_t i = 0; i < MaxNumCoroutines; ++i)
+        m_free_frames.send(i);
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::~os_coroutine_scheduler()
+{
+    m_is_stopping.store(true);
+    m_listener.notify();
+    os_binary_semaphore_take(m_stopped_sem, os_no_timeout);
+    os_binary_semaphore_delete(m_stopped_sem);
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+bool os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::spawn(os_coroutine coroutine)
+{
+    if (!coroutine)
+        return false;
+
+    // There are never more coroutines than frames, so the queue can't be full.
+    m_spawned.send(coroutine.release());
+    m_listener.notify();
+    return true;
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+auto os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::delay(unsigned time_ms)
+{
+    return make_awaitable<bool>(
+        waitable{nullptr, nullptr}, time_ms, [](std::optional<bool> &result, bool is_timed_out) {
+            if (is_timed_out)
+                result = true;
+            return is_timed_out;
+        });
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+template <typename Queue>
+auto os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::receive(Queue &queue, unsigned timeout_ms)
+{
+    using result = decltype(queue.receive(0));
+    return make_awaitable<result>(
+        make_waitable(queue), timeout_ms, [&queue](std::optional<result> &res, bool is_timed_out) {
+            auto element = queue.receive(0);
+            if (element.isLeft || is_timed_out)
+                res.emplace(std::move(element));
+            return res.has_value();
+        });
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+auto os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::wait_set(os_flag &flag, unsigned timeout_ms)
+{
+    return make_awaitable<bool>(make_waitable(flag), timeout_ms, [&flag](std::optional<bool> &res, bool is_timed_out) {
+        auto is_set = flag.is_set();
+        if (is_set || is_timed_out)
+            res = is_set;
+        return res.has_value();
+    });
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+template <typename CharDriver>
+auto os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::readline(CharDriver &driver,
+                                                                   char *buf,
+                                                                   size_t buf_size,
+                                                                   unsigned timeout_ms)
+{
+    return make_awaitable<size_t>(
+        make_waitable(driver), timeout_ms, [&driver, buf, buf_size](std::optional<size_t> &res, bool is_timed_out) {
+            // The drivers never deliver empty lines, so zero bytes mean that there is no line, also when another
+            // reader has taken it after the wake-up. The coroutine keeps waiting then.
+            auto len = driver.readline(buf, buf_size, 0);
+            if (len > 0 || is_timed_out)
+                res = len;
+            return res.has_value();
+        });
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void *os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::allocate_frame(size_t size)
+{
+    if (size > sizeof(frame_block))
+        return nullptr;
+
+    auto idx = m_free_frames.receive(0);
+    if (!idx.isLeft)
+        return nullptr;
+    return m_frames[idx.leftValue].storage;
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::deallocate_frame(void *block)
+{
+    m_free_frames.send(static_cast<size_t>(static_cast<frame_block *>(block) - m_frames));
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+template <typename Result, typename Operation>
+typename os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::template awaitable<Result, Operation>
+os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::make_awaitable(waitable object,
+                                                                    unsigned timeout_ms,
+                                                                    Operation operation)
+{
+    return awaitable<Result, Operation>(*this, object, timeout_ms, std::move(operation));
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+template <typename Waitable>
+typename os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::waitable
+os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::make_waitable(Waitable &object)
+{
+    return waitable{&object, [](void *object, os_wait_set_listener *listener) {
+                        static_cast<Waitable *>(object)->attach_listener(listener);
+                    }};
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize> void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::run()
+{
+    while (!m_is_stopping.load())
+    {
+        collect_ready();
+        if (m_num_ready == 0)
+        {
+            wait_for_ready();
+            continue;
+        }
+
+        // The coroutines become ready only in collect_ready(), so the ring is emptied.
+        while (m_num_ready > 0)
+        {
+            auto coroutine = take_ready();
+            coroutine.resume();
+            if (coroutine.done())
+                coroutine.destroy();
+        }
+    }
+
+    destroy_coroutines();
+    os_binary_semaphore_give(m_stopped_sem);
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::suspend(const waiter &w)
+{
+    if (w.object.object)
+        w.object.attach_listener(w.object.object, &m_listener);
+    m_waiters[m_num_waiters++] = w;
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::collect_ready()
+{
+    collect_spawned();
+
+    auto now = os_get_tick_count();
+    for (size_t i = 0; i < m_num_waiters;)
+    {
+        auto &w = m_waiters[i];
+        // The tick count is unsigned, so the difference is immune to its overflow.
+        bool is_timed_out = w.timeout != os_no_timeout && now - w.start >= w.timeout;
+        if (w.try_complete(w.awaitable, is_timed_out))
+        {
+            make_ready(w.coroutine);
+            remove_waiter(i);
+        }
+        else
+            ++i;
+    }
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::collect_spawned()
+{
+    while (true)
+    {
+        auto spawned = m_spawned.receive(0);
+        if (!spawned.isLeft)
+            break;
+        make_ready(spawned.leftValue);
+    }
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::wait_for_ready()
+{
+    m_listener.arm();
+    collect_ready();
+    if (m_num_ready == 0 && !m_is_stopping.load())
+        m_listener.block(nearest_timeout());
+    m_listener.disarm();
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+os_tick_type_t os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::nearest_timeout() const
+{
+    auto now = os_get_tick_count();
+    os_tick_type_t nearest = os_no_timeout;
+    for (size_t i = 0; i < m_num_waiters; ++i)
+    {
+        auto &w = m_waiters[i];
+        if (w.timeout == os_no_timeout)
+            continue;
+        os_tick_type_t elapsed = now - w.start;
+        os_tick_type_t remaining = elapsed < w.timeout ? w.timeout - elapsed : 0;
+        if (remaining < nearest)
+            nearest = remaining;
+    }
+    return nearest;
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::make_ready(std::coroutine_handle<> coroutine)
+{
+    m_ready[(m_ready_head + m_num_ready++) % MaxNumCoroutines] = coroutine;
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+std::coroutine_handle<> os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::take_ready()
+{
+    auto coroutine = m_ready[m_ready_head];
+    m_ready_head = (m_ready_head + 1) % MaxNumCoroutines;
+    --m_num_ready;
+    return coroutine;
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::remove_waiter(size_t idx)
+{
+    auto object = m_waiters[idx].object;
+    m_waiters[idx] = m_waiters[--m_num_waiters];
+
+    if (object.object == nullptr)
+        return;
+    // The object stays attached as long as any coroutine awaits it.
+    for (size_t i = 0; i < m_num_waiters; ++i)
+        if (m_waiters[i].object.object == object.object)
+            return;
+    object.attach_listener(object.object, nullptr);
+}
+
+template <size_t MaxNumCoroutines, size_t FrameSize>
+void os_coroutine_scheduler<MaxNumCoroutines, FrameSize>::destroy_coroutines()
+{
+    // The awaited objects are not checked, so that no element is consumed for a coroutine which won't run.
+    collect_spawned();
+    while (m_num_ready > 0)
+        take_ready().destroy();
+    while (m_num_waiters > 0)
+    {
+        auto coroutine = m_waiters[m_num_waiters - 1].coroutine;
+        remove_waiter(m_num_waiters - 1);
+        coroutine.destroy();
+    }
+}
+
+} // namespace jungles
+
+#endif /* OS_COROUTINE_HPP */
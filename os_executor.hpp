@@ -0,0 +1,223 @@
+/**
+ * @file	os_executor.hpp
+ * @brief	Runs jobs on a fixed pool of worker tasks.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_EXECUTOR_HPP
+#define OS_EXECUTOR_HPP
+
+#include "os.h"
+#include "os_function.hpp"
+#include "os_mpmc_queue.hpp"
+#include "os_task.hpp"
+#include <atomic>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+namespace jungles {
+
+/**
+ * \brief Runs the submitted jobs on NumWorkers worker tasks, instead of a task per piece of deferred work.
+ *
+ * The jobs are stored in os_function, so submitting never allocates. A job is put to a bounded queue of QueueSize
+ * elements; submit() doesn't block and returns false when the queue is full. Jobs submitted with submit_urgent() are
+ * put to a separate queue of the same size, which the workers empty first, so an urgent job waits at most for the
+ * jobs which are already running.
+ *
+ * When LocalQueueSize is non-zero, each worker has also its own queue, of LocalQueueSize elements, to which go the
+ * jobs submitted by the jobs run by the worker. The worker takes the jobs from its local queue before the shared one,
+ * thus the related jobs run one after another on the same worker, and a worker which has nothing to do steals the jobs
+ * from the local queues of the other workers.
+ *
+ * The queue sizes must be powers of two (see os_mpmc_queue). The jobs which are queued when the executor is destroyed
+ * may be dropped; the destructor waits only for the jobs which are running, so it must not be called from a job.
+ */
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize = 0> class os_executor
+{
+    static_assert(NumWorkers > 0, "The executor must have at least one worker");
+
+  public:
+    using job = os_function<void(void)>;
+
+    /**
+     *	\brief Creates the workers.
+     *	\param[in] name				The name of the worker tasks.
+     *	\param[in] stack_size		The size of the stack of each worker.
+     *	\param[in] priority			The priority of the workers.
+     */
+    os_executor(const char *name, unsigned short stack_size, os_base_type_t priority);
+
+    ~os_executor();
+
+    os_executor(const os_executor &) = delete;
+    os_executor &operator=(const os_executor &) = delete;
+    os_executor(os_executor &&) = delete;
+    os_executor &operator=(os_executor &&) = delete;
+
+    //! Returns true when the job has been queued, false when the queue is full.
+    bool submit(job j);
+
+    //! Works like submit(), but the job is run before all the jobs queued with submit().
+    bool submit_urgent(job j);
+
+  private:
+    static constexpr bool has_local_queues = LocalQueueSize > 0;
+
+    struct no_local_queue
+    {
+    };
+
+    using local_queue = std::conditional_t<has_local_queues, os_mpmc_queue<job, LocalQueueSize>, no_local_queue>;
+
+    //! Body of the worker task.
+    void work(size_t worker);
+
+    //! Returns an empty job when there is none to take.
+    job take_job(size_t worker);
+
+    //! Returns the worker which runs the calling task or NumWorkers when the caller is not a worker.
+    size_t current_worker() const;
+
+    template <typename Queue> bool enqueue(Queue &queue, job &j);
+    template <typename Queue> static bool dequeue(Queue &queue, job &j);
+
+    //! Counts the queued jobs, thus tells the workers when to wake up.
+    os_counting_semaphore_t m_num_jobs_sem;
+    //! Given by the workers when they finish on destruction.
+    os_counting_semaphore_t m_num_stopped_sem;
+    std::atomic<bool> m_is_stopping{false};
+
+    os_mpmc_queue<job, QueueSize> m_urgent_jobs;
+    os_mpmc_queue<job, QueueSize> m_jobs;
+    local_queue m_local_jobs[NumWorkers];
+
+    std::atomic<os_task_handle_t> m_worker_handles[NumWorkers] = {};
+    std::optional<os_task> m_workers[NumWorkers];
+};
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+os_executor<NumWorkers, QueueSize, LocalQueueSize>::os_executor(const char *name,
+                                                                unsigned short stack_size,
+                                                                os_base_type_t priority)
+    : m_num_jobs_sem{os_counting_semaphore_create(2 * QueueSize + NumWorkers * LocalQueueSize + NumWorkers, 0)},
+      m_num_stopped_sem{os_counting_semaphore_create(NumWorkers, 0)}
+{
+    for (size_t w = 0; w < NumWorkers; ++w)
+        m_workers[w].emplace([this, w]() { work(w); }, name, stack_size, priority);
+}
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+os_executor<NumWorkers, QueueSize, LocalQueueSize>::~os_executor()
+{
+    m_is_stopping.store(true);
+    for (size_t w = 0; w < NumWorkers; ++w)
+        os_counting_semaphore_give(m_num_jobs_sem);
+    for (size_t w = 0; w < NumWorkers; ++w)
+        os_counting_semaphore_take(m_num_stopped_sem, os_no_timeout);
+
+    // The workers must be deleted before the semaphores, which they use.
+    for (auto &worker : m_workers)
+        worker.reset();
+    os_counting_semaphore_delete(m_num_stopped_sem);
+    os_counting_semaphore_delete(m_num_jobs_sem);
+}
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+bool os_executor<NumWorkers, QueueSize, LocalQueueSize>::submit(job j)
+{
+    if constexpr (has_local_queues)
+    {
+        auto worker = current_worker();
+        // Falls back to the shared queue when the local one is full.
+        if (worker < NumWorkers && enqueue(m_local_jobs[worker], j))
+            return true;
+    }
+    return enqueue(m_jobs, j);
+}
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+bool os_executor<NumWorkers, QueueSize, LocalQueueSize>::submit_urgent(job j)
+{
+    return enqueue(m_urgent_jobs, j);
+}
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+void os_executor<NumWorkers, QueueSize, LocalQueueSize>::work(size_t worker)
+{
+    m_worker_handles[worker].store(os_task_get_current_task_handle());
+    while (true)
+    {
+        os_counting_semaphore_take(m_num_jobs_sem, os_no_timeout);
+
+        auto j = take_job(worker);
+        while (!j)
+        {
+            if (m_is_stopping.load())
+            {
+                os_counting_semaphore_give(m_num_stopped_sem);
+                return;
+            }
+            // The job is counted, but its producer is still putting it to the queue. Sleep, instead of yielding, to
+            // let the producer finish, also when it has a lower priority. One tick, since 1 ms may round down to none.
+            os_delay_ticks(1);
+            j = take_job(worker);
+        }
+        j();
+    }
+}
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+typename os_executor<NumWorkers, QueueSize, LocalQueueSize>::job
+os_executor<NumWorkers, QueueSize, LocalQueueSize>::take_job(size_t worker)
+{
+    job j;
+    if (dequeue(m_urgent_jobs, j))
+        return j;
+    if constexpr (has_local_queues)
+        if (dequeue(m_local_jobs[worker], j))
+            return j;
+    if (dequeue(m_jobs, j))
+        return j;
+    if constexpr (has_local_queues)
+        for (size_t i = 1; i < NumWorkers; ++i)
+            if (dequeue(m_local_jobs[(worker + i) % NumWorkers], j))
+                return j;
+    return j;
+}
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+size_t os_executor<NumWorkers, QueueSize, LocalQueueSize>::current_worker() const
+{
+    auto self = os_task_get_current_task_handle();
+    for (size_t w = 0; w < NumWorkers; ++w)
+        if (m_worker_handles[w].load(std::memory_order_relaxed) == self)
+            return w;
+    return NumWorkers;
+}
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+template <typename Queue>
+bool os_executor<NumWorkers, QueueSize, LocalQueueSize>::enqueue(Queue &queue, job &j)
+{
+    // The job is moved only when the queue accepts it.
+    if (!queue.send(std::move(j)))
+        return false;
+    os_counting_semaphore_give(m_num_jobs_sem);
+    return true;
+}
+
+template <size_t NumWorkers, size_t QueueSize, size_t LocalQueueSize>
+template <typename Queue>
+bool os_executor<NumWorkers, QueueSize, LocalQueueSize>::dequeue(Queue &queue, job &j)
+{
+    auto res = queue.receive(0);
+    if (!res.isLeft)
+        return false;
+    j = std::move(res.leftValue);
+    return true;
+}
+
+} // namespace jungles
+
+#endif /* OS_EXECUTOR_HPP */
@@ -7,6 +7,8 @@
 #define OS_FLAG_HPP
 
 #include "os.h"
+#include "os_wait_set.hpp"
+#include <atomic>
 
 namespace jungles {
 
@@ -28,6 +30,12 @@ class os_flag
     void reset();
     bool is_set();
 
+    //! The same as is_set(). Used by os_wait_set.
+    bool is_ready();
+
+    //! Makes the flag notify the listener when it is set. Used by os_wait_set.
+    void attach_listener(os_wait_set_listener *listener);
+
     os_flag(const os_flag &) = delete;
     os_flag(os_flag &&) = delete;
     os_flag &operator=(const os_flag &) = delete;
@@ -35,38 +43,53 @@ class os_flag
 
   private:
     os_event_group_handle_t event_group;
+
+    //! Listener of the os_wait_set the flag belongs to, if any.
+    std::atomic<os_wait_set_listener *> listener{nullptr};
 };
 
-os_flag::os_flag()
+inline os_flag::os_flag()
 {
     event_group = os_event_group_create();
 }
 
-os_flag::~os_flag()
+inline os_flag::~os_flag()
 {
     os_event_group_delete(event_group);
 }
 
-void os_flag::wait_set()
+inline void os_flag::wait_set()
 {
     os_event_group_wait_bits_endlessly(event_group, 0x01, os_false, os_false);
 }
 
-void os_flag::set()
+inline void os_flag::set()
 {
     os_event_group_set_bits(event_group, 0x01);
+    if (auto l = listener.load())
+        l->notify();
 }
 
-void os_flag::reset()
+inline void os_flag::reset()
 {
     os_event_group_clear_bits(event_group, 0x01);
 }
 
-bool os_flag::is_set()
+inline bool os_flag::is_set()
 {
     return os_event_group_get_bits(event_group) & 0x01;
 }
 
+inline bool os_flag::is_ready()
+{
+    return is_set();
+}
+
+inline void os_flag::attach_listener(os_wait_set_listener *l)
+{
+    listener.store(l);
+}
+
 } // namespace jungles
 
 #endif /* OS_FLAG_HPP */
@@ -0,0 +1,283 @@
+/**
+ * @file	os_framing.hpp
+ * @brief	Framings which split a byte stream into lines or binary frames.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_FRAMING_HPP
+#define OS_FRAMING_HPP
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+namespace jungles {
+
+/**
+ * \brief Tells the receiver what to do with a received byte.
+ *
+ * A framing is a class which provides the members below. The receiver (see os_rx_line_buffer) never delivers empty
+ * frames, so the framing may end a frame regardless of whether any data has been received.
+ *
+ *      // True when a frame, which did not fit into the receiver's buffer, shall be delivered truncated.
+ *      static constexpr bool keeps_truncated_frames;
+ *
+ *      // Decodes the byte in place.
+ *      os_frame_event decode(char &c, bool is_frame_empty);
+ *
+ *      // Returns the number of the leading bytes which are frame data stored as they are, and consumes them.
+ *      // Allows the receiver to copy them in bulk. Returning zero makes the receiver call decode() for the next byte.
+ *      size_t consume_data_run(const char *beg, const char *end, bool is_frame_empty);
+ *
+ *      // Binary framings only. Calls emit(const char *, size_t) for each consecutive part of the encoded frame.
+ *      template <typename Emit> static void encode(const char *data, size_t len, Emit &&emit);
+ */
+enum class os_frame_event
+{
+    //! The byte is not a part of the frame data, e.g. it is an escape char.
+    none,
+    //! The (decoded) byte is a part of the frame.
+    data,
+    //! The byte ends the frame.
+    end,
+    //! The byte is a part of the frame and ends it.
+    data_and_end,
+    //! The frame is malformed and shall be dropped.
+    error
+};
+
+namespace detail {
+
+//! Returns the first of the chars within [beg, end) or end when there is none.
+inline const char *find_any_of(const char *beg, const char *end, std::string_view chars)
+{
+    // Each word is checked against all the chars at once with the "has zero byte" trick: a byte of
+    // word ^ broadcast(char) is zero only where the char is. The exact position is then found bytewise.
+    using word = size_t;
+    static constexpr word ones = ~word{0} / 0xFF;
+    static constexpr word highs = ones * 0x80;
+
+    for (; std::distance(beg, end) >= static_cast<std::ptrdiff_t>(sizeof(word)); beg += sizeof(word))
+    {
+        word w;
+        std::memcpy(&w, beg, sizeof(word));
+        bool has_char = false;
+        for (char c : chars)
+        {
+            word v = w ^ (ones * static_cast<unsigned char>(c));
+            has_char |= ((v - ones) & ~v & highs) != 0;
+        }
+        if (has_char)
+            break;
+    }
+
+    return std::find_if(beg, end, [chars](char c) { return chars.find(c) != std::string_view::npos; });
+}
+
+} // namespace detail
+
+/**
+ * \brief Splits the stream into text lines.
+ *
+ * A line ends on any of the terminators. The terminators themselves are not stored and empty lines are skipped, so
+ * e.g. "\r\n" ends a line only once. An exceptional char received as the first char of a line forms a complete line
+ * on its own, which allows to handle prompts which are not followed by any terminator (e.g. '>' sent by modems).
+ * Lines which do not fit into the receiver's buffer are delivered truncated.
+ */
+class os_line_framing
+{
+  public:
+    static inline constexpr bool keeps_truncated_frames = true;
+
+    explicit os_line_framing(std::string_view exceptional_chars = std::string_view{""},
+                             std::string_view terminators = std::string_view{"\0\r\n", 3})
+        : m_exceptional_chars{exceptional_chars}, m_terminators{terminators}
+    {
+    }
+
+    os_frame_event decode(char &c, bool is_frame_empty) const
+    {
+        if (m_terminators.find(c) != std::string_view::npos)
+            return os_frame_event::end;
+        if (is_frame_empty && m_exceptional_chars.find(c) != std::string_view::npos)
+            return os_frame_event::data_and_end;
+        return os_frame_event::data;
+    }
+
+    size_t consume_data_run(const char *beg, const char *end, bool is_frame_empty) const
+    {
+        // The exceptional chars matter only at the beginning of a line.
+        if (is_frame_empty)
+            return 0;
+        return std::distance(beg, detail::find_any_of(beg, end, m_terminators));
+    }
+
+  private:
+    std::string_view m_exceptional_chars;
+    std::string_view m_terminators;
+};
+
+/**
+ * \brief SLIP framing (RFC 1055).
+ *
+ * The frames are delimited by the END byte and the END and ESC bytes within the data are escaped. Malformed and
+ * truncated frames are dropped.
+ */
+class os_slip_framing
+{
+  public:
+    static inline constexpr bool keeps_truncated_frames = false;
+
+    static inline constexpr char end_byte = '\xC0';
+    static inline constexpr char esc_byte = '\xDB';
+    static inline constexpr char esc_end_byte = '\xDC';
+    static inline constexpr char esc_esc_byte = '\xDD';
+
+    os_frame_event decode(char &c, bool)
+    {
+        if (c == end_byte)
+        {
+            auto is_malformed = m_is_escaped;
+            m_is_escaped = m_is_discarding = false;
+            return is_malformed ? os_frame_event::error : os_frame_event::end;
+        }
+
+        if (m_is_discarding)
+            return os_frame_event::none;
+
+        if (m_is_escaped)
+        {
+            m_is_escaped = false;
+            if (c == esc_end_byte || c == esc_esc_byte)
+            {
+                c = c == esc_end_byte ? end_byte : esc_byte;
+                return os_frame_event::data;
+            }
+            // The rest of the frame is ignored.
+            m_is_discarding = true;
+            return os_frame_event::error;
+        }
+
+        if (c == esc_byte)
+        {
+            m_is_escaped = true;
+            return os_frame_event::none;
+        }
+        return os_frame_event::data;
+    }
+
+    size_t consume_data_run(const char *beg, const char *end, bool) const
+    {
+        if (m_is_escaped || m_is_discarding)
+            return 0;
+        return std::distance(beg, detail::find_any_of(beg, end, special_bytes));
+    }
+
+    template <typename Emit> static void encode(const char *data, size_t len, Emit &&emit)
+    {
+        static constexpr char escaped_end[] = {esc_byte, esc_end_byte};
+        static constexpr char escaped_esc[] = {esc_byte, esc_esc_byte};
+
+        // The leading END flushes any line noise received by the peer before the frame.
+        emit(&end_byte, 1);
+        for (auto end = data + len; data != end;)
+        {
+            auto special = detail::find_any_of(data, end, special_bytes);
+            if (special != data)
+                emit(data, std::distance(data, special));
+            if (special == end)
+                break;
+            emit(*special == end_byte ? escaped_end : escaped_esc, 2);
+            data = special + 1;
+        }
+        emit(&end_byte, 1);
+    }
+
+  private:
+    static inline constexpr std::string_view special_bytes{"\xC0\xDB"};
+
+    bool m_is_escaped{false};
+    bool m_is_discarding{false};
+};
+
+/**
+ * \brief Consistent Overhead Byte Stuffing framing.
+ *
+ * The frames are delimited by zero bytes and the data is encoded in blocks, each starting with a code byte which tells
+ * where the next zero is. The overhead is at most one byte per 254 bytes of data. Frames whose blocks are cut by the
+ * delimiter and truncated frames are dropped.
+ */
+class os_cobs_framing
+{
+  public:
+    static inline constexpr bool keeps_truncated_frames = false;
+
+    static inline constexpr char delimiter = '\0';
+
+    os_frame_event decode(char &c, bool)
+    {
+        if (c == delimiter)
+        {
+            auto is_malformed = m_block_remaining != 0;
+            m_block_remaining = 0;
+            m_is_zero_pending = false;
+            return is_malformed ? os_frame_event::error : os_frame_event::end;
+        }
+
+        if (m_block_remaining > 0)
+        {
+            --m_block_remaining;
+            return os_frame_event::data;
+        }
+
+        // A code byte: the zero which ended the previous block is a part of the data, unless the frame ends here.
+        auto code = static_cast<unsigned char>(c);
+        auto is_zero_pending = m_is_zero_pending;
+        m_block_remaining = code - 1;
+        m_is_zero_pending = code != max_code;
+        if (!is_zero_pending)
+            return os_frame_event::none;
+        c = '\0';
+        return os_frame_event::data;
+    }
+
+    size_t consume_data_run(const char *beg, const char *end, bool)
+    {
+        auto run_end = beg + std::min<size_t>(m_block_remaining, std::distance(beg, end));
+        auto n = static_cast<size_t>(std::distance(beg, std::find(beg, run_end, delimiter)));
+        m_block_remaining -= n;
+        return n;
+    }
+
+    template <typename Emit> static void encode(const char *data, size_t len, Emit &&emit)
+    {
+        // The leading delimiter flushes any line noise received by the peer before the frame.
+        emit(&delimiter, 1);
+        for (auto end = data + len;;)
+        {
+            auto block_end = data + std::min<size_t>(max_code - 1, std::distance(data, end));
+            auto zero = std::find(data, block_end, delimiter);
+            auto code = static_cast<char>(std::distance(data, zero) + 1);
+            emit(&code, 1);
+            if (zero != data)
+                emit(data, std::distance(data, zero));
+            if (zero == end)
+                break;
+            // A full block is not followed by an implicit zero.
+            data = zero == block_end ? zero : zero + 1;
+        }
+        emit(&delimiter, 1);
+    }
+
+  private:
+    static inline constexpr unsigned max_code = 0xFF;
+
+    //! Number of data bytes till the end of the current block.
+    size_t m_block_remaining{0};
+    //! Whether the current block is followed by a zero, which is a part of the data.
+    bool m_is_zero_pending{false};
+};
+
+} // namespace jungles
+
+#endif /* OS_FRAMING_HPP */
@@ -0,0 +1,170 @@
+/**
+ * @file	os_function.hpp
+ * @brief	Definition of a functional object wrapper which never allocates.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_FUNCTION_HPP
+#define OS_FUNCTION_HPP
+
+#include <cstddef>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace jungles {
+
+//! Fits a lambda capturing four pointers or references.
+constexpr size_t os_function_default_capacity = 4 * sizeof(void *);
+
+template <typename Signature, size_t Capacity = os_function_default_capacity> class os_function;
+
+/**
+ * \brief Works like std::function, but the functional object is always stored within os_function.
+ *
+ * std::function allocates the functional object on the heap when it does not fit in its small internal buffer,
+ * e.g. when a lambda captures more than two pointers, and the size of the buffer is unspecified. os_function
+ * has a buffer of Capacity bytes and fails to compile when the functional object does not fit, so creating, copying
+ * and calling it never allocates:
+ *
+ *      os_function<void(char)> f{[&drv, &line, &flag](char c) { ... }};
+ *
+ * The stored functional object must be copy constructible. Calling an empty os_function is undefined behaviour.
+ */
+template <typename R, typename... Args, size_t Capacity> class os_function<R(Args...), Capacity>
+{
+  public:
+    os_function() noexcept = default;
+    os_function(std::nullptr_t) noexcept;
+
+    template <typename F, typename = std::enable_if_t<!std::is_same_v<std::decay_t<F>, os_function>>>
+    os_function(F &&f);
+
+    os_function(const os_function &other);
+    os_function(os_function &&other);
+    os_function &operator=(const os_function &other);
+    os_function &operator=(os_function &&other);
+    os_function &operator=(std::nullptr_t) noexcept;
+    ~os_function();
+
+    R operator()(Args... args) const;
+
+    explicit operator bool() const noexcept;
+
+  private:
+    struct operations
+    {
+        R (*invoke)(void *f, Args &&... args);
+        void (*copy)(void *dst, const void *src);
+        void (*move)(void *dst, void *src);
+        void (*destroy)(void *f);
+    };
+
+    template <typename F> static const operations operations_of;
+
+    void reset() noexcept;
+
+    alignas(std::max_align_t) mutable unsigned char m_storage[Capacity];
+    const operations *m_operations{nullptr};
+};
+
+template <typename R, typename... Args, size_t Capacity>
+template <typename F>
+const typename os_function<R(Args...), Capacity>::operations os_function<R(Args...), Capacity>::operations_of{
+    [](void *f, Args &&... args) -> R { return (*static_cast<F *>(f))(std::forward<Args>(args)...); },
+    [](void *dst, const void *src) { new (dst) F(*static_cast<const F *>(src)); },
+    [](void *dst, void *src) { new (dst) F(std::move(*static_cast<F *>(src))); },
+    [](void *f) { static_cast<F *>(f)->~F(); },
+};
+
+template <typename R, typename... Args, size_t Capacity>
+os_function<R(Args...), Capacity>::os_function(std::nullptr_t) noexcept
+{
+}
+
+template <typename R, typename... Args, size_t Capacity>
+template <typename F, typename>
+os_function<R(Args...), Capacity>::os_function(F &&f)
+{
+    using functor = std::decay_t<F>;
+    static_assert(sizeof(functor) <= Capacity, "The functional object doesn't fit in os_function, increase Capacity");
+    static_assert(alignof(functor) <= alignof(std::max_align_t), "The functional object is overaligned");
+    static_assert(std::is_copy_constructible_v<functor>, "The functional object must be copy constructible");
+
+    new (m_storage) functor(std::forward<F>(f));
+    m_operations = &operations_of<functor>;
+}
+
+template <typename R, typename... Args, size_t Capacity>
+os_function<R(Args...), Capacity>::os_function(const os_function &other) : m_operations{other.m_operations}
+{
+    if (m_operations)
+        m_operations->copy(m_storage, other.m_storage);
+}
+
+template <typename R, typename... Args, size_t Capacity>
+os_function<R(Args...), Capacity>::os_function(os_function &&other) : m_operations{other.m_operations}
+{
+    if (m_operations)
+        m_operations->move(m_storage, other.m_storage);
+}
+
+template <typename R, typename... Args, size_t Capacity>
+os_function<R(Args...), Capacity> &os_function<R(Args...), Capacity>::operator=(const os_function &other)
+{
+    if (this != &other)
+    {
+        reset();
+        if (other.m_operations)
+            other.m_operations->copy(m_storage, other.m_storage);
+        m_operations = other.m_operations;
+    }
+    return *this;
+}
+
+template <typename R, typename... Args, size_t Capacity>
+os_function<R(Args...), Capacity> &os_function<R(Args...), Capacity>::operator=(os_function &&other)
+{
+    if (this != &other)
+    {
+        reset();
+        if (other.m_operations)
+            other.m_operations->move(m_storage, other.m_storage);
+        m_operations = other.m_operations;
+    }
+    return *this;
+}
+
+template <typename R, typename... Args, size_t Capacity>
+os_function<R(Args...), Capacity> &os_function<R(Args...), Capacity>::operator=(std::nullptr_t) noexcept
+{
+    reset();
+    return *this;
+}
+
+template <typename R, typename... Args, size_t Capacity> os_function<R(Args...), Capacity>::~os_function()
+{
+    reset();
+}
+
+template <typename R, typename... Args, size_t Capacity>
+R os_function<R(Args...), Capacity>::operator()(Args... args) const
+{
+    return m_operations->invoke(m_storage, std::forward<Args>(args)...);
+}
+
+template <typename R, typename... Args, size_t Capacity>
+os_function<R(Args...), Capacity>::operator bool() const noexcept
+{
+    return m_operations != nullptr;
+}
+
+template <typename R, typename... Args, size_t Capacity> void os_function<R(Args...), Capacity>::reset() noexcept
+{
+    if (m_operations)
+        m_operations->destroy(m_storage);
+    m_operations = nullptr;
+}
+
+} // namespace jungles
+
+#endif /* OS_FUNCTION_HPP */
@@ -0,0 +1,107 @@
+/**
+ * @file	os_line_dispatcher.hpp
+ * @brief	Serves the lines received by many char drivers from a single task.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_LINE_DISPATCHER_HPP
+#define OS_LINE_DISPATCHER_HPP
+
+#include "os.h"
+#include "os_function.hpp"
+#include "os_wait_set.hpp"
+#include <string_view>
+
+namespace jungles {
+
+/**
+ * \brief Invokes a handler registered for a char driver (e.g. os_char_driver) each time the driver receives a line.
+ *
+ * The handlers are called from the task which calls dispatch(), so a single task can serve many ports, instead of
+ * a task blocked in readline() per port. The line is read to an internal buffer of MaxLineLen bytes and it is valid
+ * only until the handler returns; longer lines are truncated. The ports are served in round-robin order, thus a busy
+ * port does not starve the others. Works for binary frames the same way.
+ */
+template <size_t MaxNumPorts, size_t MaxLineLen> class os_line_dispatcher
+{
+  public:
+    using line_handler = os_function<void(std::string_view)>;
+
+    os_line_dispatcher() = default;
+
+    os_line_dispatcher(const os_line_dispatcher &) = delete;
+    os_line_dispatcher &operator=(const os_line_dispatcher &) = delete;
+    os_line_dispatcher(os_line_dispatcher &&) = delete;
+    os_line_dispatcher &operator=(os_line_dispatcher &&) = delete;
+
+    //! Registers the handler of the lines received by the driver. Returns the index of the port.
+    template <typename CharDriver> size_t add(CharDriver &driver, line_handler handler);
+
+    /**
+     * \brief Awaits a line on any of the ports and passes it to the port's handler.
+     *
+     * When another reader of a driver takes the line after the driver has been reported ready, the ports are awaited
+     * again for the rest of the timeout. A driver doesn't report the lines reserved by its other readers, thus the
+     * wait blocks until the next line instead of spinning.
+     *
+     * \returns True when a line has been dispatched, false on timeout.
+     */
+    bool dispatch(unsigned timeout_ms);
+
+  private:
+    struct port
+    {
+        void *driver;
+        size_t (*read)(void *driver, char *buf, size_t buf_size);
+        line_handler handler;
+    };
+
+    port m_ports[MaxNumPorts];
+    os_wait_set<MaxNumPorts> m_wait_set;
+    char m_line[MaxLineLen];
+};
+
+template <size_t MaxNumPorts, size_t MaxLineLen>
+template <typename CharDriver>
+size_t os_line_dispatcher<MaxNumPorts, MaxLineLen>::add(CharDriver &driver, line_handler handler)
+{
+    auto idx = m_wait_set.add(driver);
+    m_ports[idx] = port{
+        &driver,
+        [](void *driver, char *buf, size_t buf_size) {
+            return static_cast<CharDriver *>(driver)->readline(buf, buf_size, 0);
+        },
+        std::move(handler),
+    };
+    return idx;
+}
+
+template <size_t MaxNumPorts, size_t MaxLineLen>
+bool os_line_dispatcher<MaxNumPorts, MaxLineLen>::dispatch(unsigned timeout_ms)
+{
+    TickType_t timeout = os_timeout_to_ticks(timeout_ms);
+    TimeOut_t timeout_state;
+    vTaskSetTimeOutState(&timeout_state);
+
+    while (true)
+    {
+        auto ready = m_wait_set.wait(timeout);
+        if (!ready.isLeft)
+            return false;
+
+        // The drivers never deliver empty lines, so zero means that another reader has taken the line.
+        auto &p = m_ports[ready.leftValue];
+        auto len = p.read(p.driver, m_line, MaxLineLen);
+        if (len > 0)
+        {
+            p.handler(std::string_view{m_line, len});
+            return true;
+        }
+
+        if (xTaskCheckForTimeOut(&timeout_state, &timeout) == pdTRUE)
+            return false;
+    }
+}
+
+} // namespace jungles
+
+#endif /* OS_LINE_DISPATCHER_HPP */
@@ -0,0 +1,197 @@
+/**
+ * @file	os_mpmc_queue.hpp
+ * @brief	Lock-free multi-producer/multi-consumer queue with the os_queue interface.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_MPMC_QUEUE_HPP
+#define OS_MPMC_QUEUE_HPP
+
+#include "FreeRTOS.h"
+#include "neither/neither.hpp"
+#include "semphr.h"
+#include "task.h"
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+//! Alignment used to keep the producers' and the consumers' indices on separate cache lines.
+#ifndef OS_CACHE_LINE_SIZE
+#define OS_CACHE_LINE_SIZE 64
+#endif
+
+namespace jungles {
+
+/**
+ * \brief Bounded lock-free queue which can be used by multiple producers and multiple consumers at the same time.
+ *
+ * Each slot has a sequence counter which tells whether the slot may be written by a producer or read by a consumer,
+ * thus producers and consumers only contend on their own index, which is placed on a separate cache line. It makes
+ * the queue suitable for FreeRTOS SMP, where the tasks run on different cores. The kernel is touched only when
+ * a consumer must block on an empty queue and when a producer must wake such consumers up. send() never blocks, like
+ * in os_queue.
+ */
+template <typename T, size_t N> class os_mpmc_queue
+{
+    static_assert(N >= 2 && (N & (N - 1)) == 0, "The capacity must be a power of two");
+
+  public:
+    explicit os_mpmc_queue();
+
+    ~os_mpmc_queue();
+
+    os_mpmc_queue(const os_mpmc_queue &) = delete;
+    os_mpmc_queue &operator=(const os_mpmc_queue &) = delete;
+    os_mpmc_queue(os_mpmc_queue &&) = delete;
+    os_mpmc_queue &operator=(os_mpmc_queue &&) = delete;
+
+    //! Returns true when the element has been sent correctly to the queue, false otherwise.
+    template <typename... U> bool send(U &&... u);
+
+    //! Either returns an element from the queue or returns false when timeout occured while awaiting for an element.
+    neither::Either<T, bool> receive(TickType_t timeout);
+
+  private:
+    struct cell
+    {
+        //! Equal to the position when the cell is free and to the position + 1 when it holds an element.
+        std::atomic<size_t> sequence;
+        std::aligned_storage_t<sizeof(T), alignof(T)> storage;
+
+        T *element()
+        {
+            return std::launder(reinterpret_cast<T *>(&storage));
+        }
+    };
+
+    cell m_cells[N];
+
+    alignas(OS_CACHE_LINE_SIZE) std::atomic<size_t> m_enqueue_pos{0};
+    alignas(OS_CACHE_LINE_SIZE) std::atomic<size_t> m_dequeue_pos{0};
+
+    //! Number of consumers which are blocked, or are going to block, on the empty queue.
+    alignas(OS_CACHE_LINE_SIZE) std::atomic<unsigned> m_num_waiting_consumers{0};
+
+    //! Counting semaphore used to wake up the consumers blocked on the empty queue.
+    SemaphoreHandle_t m_not_empty_sem;
+
+    cell *claim_filled(size_t &pos);
+    void wake_consumer();
+};
+
+template <typename T, size_t N>
+os_mpmc_queue<T, N>::os_mpmc_queue() : m_not_empty_sem{xSemaphoreCreateCounting(N, 0)}
+{
+    for (size_t i = 0; i < N; ++i)
+        m_cells[i].sequence.store(i, std::memory_order_relaxed);
+}
+
+template <typename T, size_t N> os_mpmc_queue<T, N>::~os_mpmc_queue()
+{
+    for (auto pos = m_dequeue_pos.load(), end = m_enqueue_pos.load(); pos != end; ++pos)
+        m_cells[pos & (N - 1)].element()->~T();
+    vSemaphoreDelete(m_not_empty_sem);
+}
+
+template <typename T, size_t N> template <typename... U> bool os_mpmc_queue<T, N>::send(U &&... u)
+{
+    auto pos = m_enqueue_pos.load(std::memory_order_relaxed);
+    cell *c;
+    while (true)
+    {
+        c = &m_cells[pos & (N - 1)];
+        auto dif = static_cast<intptr_t>(c->sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos);
+        if (dif == 0)
+        {
+            if (m_enqueue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                break;
+        }
+        else if (dif < 0)
+        {
+            // The consumers have not freed the cell yet, so the queue is full.
+            return false;
+        }
+        else
+        {
+            pos = m_enqueue_pos.load(std::memory_order_relaxed);
+        }
+    }
+
+    new (c->element()) T(std::forward<U>(u)...);
+    c->sequence.store(pos + 1, std::memory_order_release);
+    wake_consumer();
+    return true;
+}
+
+template <typename T, size_t N> neither::Either<T, bool> os_mpmc_queue<T, N>::receive(TickType_t timeout)
+{
+    size_t pos;
+    auto c = claim_filled(pos);
+    if (c == nullptr)
+    {
+        TimeOut_t timeout_state;
+        vTaskSetTimeOutState(&timeout_state);
+
+        // The registration must be visible to the producers before the queue is checked again. Otherwise a producer
+        // could miss the consumer which is going to block.
+        m_num_waiting_consumers.fetch_add(1);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        while ((c = claim_filled(pos)) == nullptr)
+        {
+            // The semaphore may also be given for an element which was then taken by another consumer.
+            if (xSemaphoreTake(m_not_empty_sem, timeout) == pdFALSE
+                || xTaskCheckForTimeOut(&timeout_state, &timeout) == pdTRUE)
+            {
+                c = claim_filled(pos);
+                break;
+            }
+        }
+        m_num_waiting_consumers.fetch_sub(1);
+
+        if (c == nullptr)
+            return neither::right(false);
+    }
+
+    auto elem = c->element();
+    T res(std::move(*elem));
+    elem->~T();
+    c->sequence.store(pos + N, std::memory_order_release);
+    return neither::left(std::move(res));
+}
+
+template <typename T, size_t N> typename os_mpmc_queue<T, N>::cell *os_mpmc_queue<T, N>::claim_filled(size_t &pos)
+{
+    pos = m_dequeue_pos.load(std::memory_order_relaxed);
+    while (true)
+    {
+        auto c = &m_cells[pos & (N - 1)];
+        auto dif =
+            static_cast<intptr_t>(c->sequence.load(std::memory_order_acquire)) - static_cast<intptr_t>(pos + 1);
+        if (dif == 0)
+        {
+            if (m_dequeue_pos.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                return c;
+        }
+        else if (dif < 0)
+        {
+            // No producer has filled the cell yet, so the queue is empty.
+            return nullptr;
+        }
+        else
+        {
+            pos = m_dequeue_pos.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+template <typename T, size_t N> void os_mpmc_queue<T, N>::wake_consumer()
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (m_num_waiting_consumers.load(std::memory_order_relaxed) > 0)
+        xSemaphoreGive(m_not_empty_sem);
+}
+
+} // namespace jungles
+
+#endif /* OS_MPMC_QUEUE_HPP */
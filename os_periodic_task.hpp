@@ -0,0 +1,160 @@
+/**
+ * @file	os_periodic_task.hpp
+ * @brief	Definition of a task which runs its code at a fixed period.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_PERIODIC_TASK_HPP
+#define OS_PERIODIC_TASK_HPP
+
+#include "os.h"
+#include "os_function.hpp"
+#include "os_task.hpp"
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace jungles {
+
+//! Timing statistics of os_periodic_task.
+struct os_periodic_task_stats
+{
+    //! The periods in which the task code has been run.
+    uint32_t num_periods;
+    //! The periods in which the task code has not finished before the start of the next period.
+    uint32_t num_deadline_misses;
+    //! The periods skipped, because they started while the task code was still running.
+    uint32_t num_overruns;
+    //! The longest execution time of the task code, in os_timestamp() units.
+    uint32_t worst_case_execution_time;
+};
+
+/**
+ * \brief Runs the task code every period_ms milliseconds, like os_task, which would loop over the code and
+ * os_delay_ms().
+ *
+ * The task wakes up at absolute times (os_task_delay_until()), so the time spent in the task code doesn't make the
+ * periods drift. The deadline of the task code is the start of the next period. When the code runs past it, the periods
+ * which have started in the meantime are skipped, thus the task code is never run back to back and the task keeps its
+ * phase. The misses and the execution times are gathered in os_periodic_task_stats.
+ *
+ * On destruction the task finishes the current period and is deleted, so it is never deleted in the middle of the
+ * task code. The period shall be a multiple of the tick period; a period shorter than a tick is rounded up to one
+ * tick.
+ */
+class os_periodic_task
+{
+  public:
+    /**
+     *	\brief Creates the task which starts with the first period immediately.
+     *	\param[in] task_code		The code run in each period.
+     *	\param[in] name				The name of the task.
+     *	\param[in] stack_size		The size of the stack allocated for the task.
+     *	\param[in] priority			The priority of the task.
+     *	\param[in] period_ms		The period; at least one tick is used.
+     *	\param[in] core_affinity	The cores the task may run on, see os_task.
+     */
+    template <typename TaskFuncType>
+    os_periodic_task(TaskFuncType &&task_code,
+                     std::string name,
+                     unsigned short stack_size,
+                     os_base_type_t priority,
+                     unsigned period_ms,
+                     os_core_affinity_mask_t core_affinity = os_core_affinity_any);
+
+    os_periodic_task(const os_periodic_task &) = delete;
+    os_periodic_task &operator=(const os_periodic_task &) = delete;
+    os_periodic_task(os_periodic_task &&) = delete;
+    os_periodic_task &operator=(os_periodic_task &&) = delete;
+    ~os_periodic_task();
+
+    os_periodic_task_stats stats() const;
+
+  private:
+    //! Body of the task.
+    void run();
+
+    //! Rounds the period up to at least one tick, otherwise the task would never wait for the next period.
+    static os_tick_type_t period_to_ticks(unsigned period_ms);
+
+    const os_tick_type_t m_period;
+    os_function<void(void)> m_task_code;
+
+    std::atomic<uint32_t> m_num_periods{0};
+    std::atomic<uint32_t> m_num_deadline_misses{0};
+    std::atomic<uint32_t> m_num_overruns{0};
+    std::atomic<uint32_t> m_worst_case_execution_time{0};
+
+    std::atomic<bool> m_is_stopping{false};
+    //! Given by the task when it has stopped on destruction.
+    os_binary_semaphore_t m_stopped_sem;
+
+    //! Constructed last, because the task starts running immediately.
+    os_task m_task;
+};
+
+template <typename TaskFuncType>
+os_periodic_task::os_periodic_task(TaskFuncType &&task_code,
+                                   std::string name,
+                                   unsigned short stack_size,
+                                   os_base_type_t priority,
+                                   unsigned period_ms,
+                                   os_core_affinity_mask_t core_affinity)
+    : m_period{period_to_ticks(period_ms)},
+      m_task_code(std::forward<TaskFuncType>(task_code)),
+      m_stopped_sem{os_binary_semaphore_create()},
+      m_task([this]() { run(); }, std::move(name), stack_size, priority, core_affinity)
+{
+}
+
+inline os_periodic_task::~os_periodic_task()
+{
+    m_is_stopping.store(true);
+    os_binary_semaphore_take(m_stopped_sem, os_no_timeout);
+    os_binary_semaphore_delete(m_stopped_sem);
+}
+
+inline os_periodic_task_stats os_periodic_task::stats() const
+{
+    return os_periodic_task_stats{m_num_periods.load(std::memory_order_relaxed),
+                                  m_num_deadline_misses.load(std::memory_order_relaxed),
+                                  m_num_overruns.load(std::memory_order_relaxed),
+                                  m_worst_case_execution_time.load(std::memory_order_relaxed)};
+}
+
+inline os_tick_type_t os_periodic_task::period_to_ticks(unsigned period_ms)
+{
+    os_tick_type_t ticks = os_timeout_to_ticks(period_ms);
+    return ticks > 0 ? ticks : 1;
+}
+
+inline void os_periodic_task::run()
+{
+    auto release_time = os_get_tick_count();
+    while (!m_is_stopping.load())
+    {
+        auto start = os_timestamp();
+        m_task_code();
+        uint32_t execution_time = os_timestamp() - start;
+
+        m_num_periods.fetch_add(1, std::memory_order_relaxed);
+        if (execution_time > m_worst_case_execution_time.load(std::memory_order_relaxed))
+            m_worst_case_execution_time.store(execution_time, std::memory_order_relaxed);
+
+        os_tick_type_t lateness = os_get_tick_count() - release_time;
+        if (lateness >= m_period)
+        {
+            m_num_deadline_misses.fetch_add(1, std::memory_order_relaxed);
+            auto num_skipped_periods = lateness / m_period;
+            m_num_overruns.fetch_add(num_skipped_periods, std::memory_order_relaxed);
+            release_time += num_skipped_periods * m_period;
+        }
+
+        os_task_delay_until(&release_time, m_period);
+    }
+    os_binary_semaphore_give(m_stopped_sem);
+}
+
+} // namespace jungles
+
+#endif /* OS_PERIODIC_TASK_HPP */
@@ -0,0 +1,147 @@
+/**
+ * @file	os_priority_queue.hpp
+ * @brief	Implementation of a queue which returns the elements with the highest priority first.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_PRIORITY_QUEUE_HPP
+#define OS_PRIORITY_QUEUE_HPP
+
+#include "FreeRTOS.h"
+#include "neither/neither.hpp"
+#include "os_lockguard.hpp"
+#include "semphr.h"
+#include <algorithm>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+namespace jungles {
+
+/**
+ * \brief Queue which works like os_queue, but receive() returns the element with the highest priority.
+ *
+ * The elements are kept in a binary heap placed in an inline, properly aligned storage, so sending and receiving takes
+ * O(log N). The priorities are compared like in std::priority_queue: the element for which Compare returns false
+ * against all the other elements is received first. Elements of equal priority are received in the order they were
+ * sent. The queue can be used by multiple producers and multiple consumers.
+ */
+template <typename T, size_t N, typename Compare = std::less<T>> class os_priority_queue
+{
+    static_assert(N > 0, "The queue must be able to hold at least one element");
+
+  public:
+    explicit os_priority_queue(const Compare &compare = Compare());
+
+    ~os_priority_queue();
+
+    os_priority_queue(const os_priority_queue &) = delete;
+    os_priority_queue &operator=(const os_priority_queue &) = delete;
+    os_priority_queue(os_priority_queue &&) = delete;
+    os_priority_queue &operator=(os_priority_queue &&) = delete;
+
+    //! Returns true when the element has been sent correctly to the queue, false otherwise.
+    template <typename... U> bool send(U &&... u);
+
+    //! Either returns the element with the highest priority or returns false when timeout occured while awaiting for
+    //! an element.
+    neither::Either<T, bool> receive(TickType_t timeout);
+
+  private:
+    struct entry
+    {
+        template <typename... U>
+        explicit entry(size_t sequence, U &&... u) : sequence{sequence}, value(std::forward<U>(u)...)
+        {
+        }
+
+        //! Ordinal number of the element, used to keep the order of the elements of equal priority.
+        size_t sequence;
+        T value;
+    };
+
+    //! Heap ordering: returns true when lhs shall be received after rhs.
+    struct entry_compare
+    {
+        bool operator()(const entry &lhs, const entry &rhs) const
+        {
+            if (compare(lhs.value, rhs.value))
+                return true;
+            if (compare(rhs.value, lhs.value))
+                return false;
+            // The difference is taken to be immune to the sequence counter overflow.
+            return static_cast<std::make_signed_t<size_t>>(lhs.sequence - rhs.sequence) > 0;
+        }
+
+        Compare compare;
+    };
+
+    //! Storage of the heap. The elements [0, m_size) are constructed.
+    std::aligned_storage_t<sizeof(entry), alignof(entry)> m_entries[N];
+    size_t m_size{0};
+    size_t m_next_sequence{0};
+    entry_compare m_compare;
+
+    //! Mutex which guards acces to the heap.
+    os_mutex_t m_mux;
+
+    //! Counting semaphore used to count how many elements are in the queue.
+    SemaphoreHandle_t m_queue_num_elems_sem;
+
+    entry *entries();
+};
+
+template <typename T, size_t N, typename Compare>
+os_priority_queue<T, N, Compare>::os_priority_queue(const Compare &compare)
+    : m_compare{compare}, m_mux{os_mutex_create()}, m_queue_num_elems_sem{xSemaphoreCreateCounting(N, 0)}
+{
+}
+
+template <typename T, size_t N, typename Compare> os_priority_queue<T, N, Compare>::~os_priority_queue()
+{
+    std::for_each(entries(), entries() + m_size, [](entry &e) { e.~entry(); });
+    os_mutex_delete(m_mux);
+    vSemaphoreDelete(m_queue_num_elems_sem);
+}
+
+template <typename T, size_t N, typename Compare>
+template <typename... U>
+bool os_priority_queue<T, N, Compare>::send(U &&... u)
+{
+    {
+        os_lockguard guard(m_mux);
+        if (m_size == N)
+            return false;
+
+        new (entries() + m_size) entry(m_next_sequence++, std::forward<U>(u)...);
+        ++m_size;
+        std::push_heap(entries(), entries() + m_size, m_compare);
+    }
+
+    xSemaphoreGive(m_queue_num_elems_sem);
+    return true;
+}
+
+template <typename T, size_t N, typename Compare>
+neither::Either<T, bool> os_priority_queue<T, N, Compare>::receive(TickType_t timeout)
+{
+    if (xSemaphoreTake(m_queue_num_elems_sem, timeout) == pdFALSE)
+        return neither::right(false);
+
+    os_lockguard guard(m_mux);
+    std::pop_heap(entries(), entries() + m_size, m_compare);
+    --m_size;
+    auto last = entries() + m_size;
+    T res(std::move(last->value));
+    last->~entry();
+    return neither::left(std::move(res));
+}
+
+template <typename T, size_t N, typename Compare> auto os_priority_queue<T, N, Compare>::entries() -> entry *
+{
+    return std::launder(reinterpret_cast<entry *>(m_entries));
+}
+
+} // namespace jungles
+
+#endif /* OS_PRIORITY_QUEUE_HPP */
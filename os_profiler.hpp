@@ -0,0 +1,194 @@
+/**
+ * @file	os_profiler.hpp
+ * @brief	Gathers the CPU usage and the stack usage of all the tasks.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_PROFILER_HPP
+#define OS_PROFILER_HPP
+
+#include "os.h"
+#include "os_task.hpp"
+#include <cstdint>
+#include <cstring>
+
+namespace jungles {
+
+//! The state of a single task taken by os_profiler::snapshot().
+struct os_task_profile
+{
+    os_task_handle_t handle;
+    //! The name given with os_profiler::register_task() or the name kept by the kernel. Valid while the task exists.
+    const char *name;
+    os_base_type_t priority;
+    //! The run time counter of the task, in the run time stats counter units.
+    uint32_t run_time;
+    //! The time the task has been running since the previous snapshot.
+    uint32_t run_time_delta;
+    //! The share of the time since the previous snapshot in which the task has been running.
+    float cpu_percent;
+    //! The minimum amount of free stack since the task has been created, in words.
+    uint32_t stack_high_water_mark;
+};
+
+/**
+ * \brief Takes snapshots of the run time counters and the stack high water marks of all the tasks.
+ *
+ * The snapshots are kept in a fixed buffer of MaxNumTasks entries, so taking them never allocates. The CPU usage of
+ * a task is computed from the difference between two consecutive snapshots, so the first snapshot reports the usage
+ * since the scheduler has started:
+ *
+ *      profiler.snapshot();
+ *      for (auto &task : profiler)
+ *          printf("%s %.1f%% %u\n", task.name, task.cpu_percent, task.stack_high_water_mark);
+ *
+ * Requires configUSE_TRACE_FACILITY and configGENERATE_RUN_TIME_STATS. The profiler shall be used by a single task.
+ * The kernel names are truncated to configMAX_TASK_NAME_LEN and may be shared by many tasks, e.g. by the workers of
+ * os_executor, so the tasks can be registered under unique names.
+ */
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks = 8> class os_profiler
+{
+  public:
+    os_profiler() = default;
+
+    os_profiler(const os_profiler &) = delete;
+    os_profiler &operator=(const os_profiler &) = delete;
+    os_profiler(os_profiler &&) = delete;
+    os_profiler &operator=(os_profiler &&) = delete;
+
+    //! Reports the task under the name, which must outlive the profiler. Returns false when there is no space left.
+    bool register_task(os_task_handle_t handle, const char *name);
+    bool register_task(const os_task &task, const char *name);
+
+    /**
+     * \brief Takes the snapshot of all the tasks.
+     *
+     * \returns False when there are more than MaxNumTasks tasks; the previous snapshot is kept then.
+     */
+    bool snapshot();
+
+    //! Returns the profile of the task with the name from the last snapshot or nullptr when there is no such task.
+    const os_task_profile *find(const char *name) const;
+
+    const os_task_profile *begin() const;
+    const os_task_profile *end() const;
+    size_t size() const;
+
+  private:
+    struct registration
+    {
+        os_task_handle_t handle;
+        const char *name;
+    };
+
+    const char *registered_name(os_task_handle_t handle) const;
+    uint32_t previous_run_time(os_task_handle_t handle) const;
+
+    //! Filled by the kernel.
+    os_task_status_t m_statuses[MaxNumTasks];
+
+    //! The last and the previous snapshot.
+    os_task_profile m_profiles[2][MaxNumTasks];
+    size_t m_num_profiles[2] = {0, 0};
+    size_t m_current{0};
+    uint32_t m_total_run_time{0};
+
+    registration m_registrations[MaxNumRegisteredTasks];
+    size_t m_num_registrations{0};
+};
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+bool os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::register_task(os_task_handle_t handle, const char *name)
+{
+    if (m_num_registrations == MaxNumRegisteredTasks)
+        return false;
+    m_registrations[m_num_registrations++] = registration{handle, name};
+    return true;
+}
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+bool os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::register_task(const os_task &task, const char *name)
+{
+    return register_task(task.get_handle(), name);
+}
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+bool os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::snapshot()
+{
+    uint32_t total_run_time = 0;
+    size_t num_tasks = os_get_system_state(m_statuses, MaxNumTasks, &total_run_time);
+    if (num_tasks == 0)
+        return false;
+
+    // The counters are unsigned, so the differences are immune to the counter overflow.
+    uint32_t total_run_time_delta = total_run_time - m_total_run_time;
+    m_total_run_time = total_run_time;
+
+    auto next = m_current ^ 1;
+    for (size_t i = 0; i < num_tasks; ++i)
+    {
+        auto &status = m_statuses[i];
+        auto &profile = m_profiles[next][i];
+        auto name = registered_name(status.xHandle);
+        uint32_t run_time = status.ulRunTimeCounter;
+        profile.handle = status.xHandle;
+        profile.name = name ? name : status.pcTaskName;
+        profile.priority = status.uxCurrentPriority;
+        profile.run_time = run_time;
+        profile.run_time_delta = run_time - previous_run_time(status.xHandle);
+        profile.cpu_percent = total_run_time_delta ? 100.0f * profile.run_time_delta / total_run_time_delta : 0.0f;
+        profile.stack_high_water_mark = status.usStackHighWaterMark;
+    }
+    m_num_profiles[next] = num_tasks;
+    m_current = next;
+    return true;
+}
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+const os_task_profile *os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::find(const char *name) const
+{
+    for (auto &profile : *this)
+        if (std::strcmp(profile.name, name) == 0)
+            return &profile;
+    return nullptr;
+}
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+const os_task_profile *os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::begin() const
+{
+    return m_profiles[m_current];
+}
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+const os_task_profile *os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::end() const
+{
+    return m_profiles[m_current] + m_num_profiles[m_current];
+}
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+size_t os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::size() const
+{
+    return m_num_profiles[m_current];
+}
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+const char *os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::registered_name(os_task_handle_t handle) const
+{
+    for (size_t i = 0; i < m_num_registrations; ++i)
+        if (m_registrations[i].handle == handle)
+            return m_registrations[i].name;
+    return nullptr;
+}
+
+template <size_t MaxNumTasks, size_t MaxNumRegisteredTasks>
+uint32_t os_profiler<MaxNumTasks, MaxNumRegisteredTasks>::previous_run_time(os_task_handle_t handle) const
+{
+    // A task created after the previous snapshot has been running only since then.
+    for (auto &profile : *this)
+        if (profile.handle == handle)
+            return profile.run_time;
+    return 0;
+}
+
+} // namespace jungles
+
+#endif /* OS_PROFILER_HPP */
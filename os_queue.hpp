@@ -8,104 +8,627 @@
 
 #include "FreeRTOS.h"
 #include "neither/neither.hpp"
-#include "os_lockguard.hpp"
+#include "os.h"
+#include "os_wait_set.hpp"
 #include "semphr.h"
-#include <cassert>
-#include <stdexcept>
-#include <vector>
+#include "task.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <new>
+#include <type_traits>
+#include <utility>
 
 namespace jungles {
 
-template <typename T, size_t N> class os_queue
+//! Statistics gathered by an instrumented os_queue.
+struct os_queue_stats
 {
+    static inline constexpr size_t num_latency_buckets = 32;
+
+    //! The highest number of elements seen in the queue.
+    std::atomic<size_t> max_depth{0};
+
+    //! The number of sends which failed because the queue was full. A partially accepted send_n() counts once.
+    std::atomic<uint32_t> num_rejected_sends{0};
+
+    /**
+     * Histogram of the time the elements spent in the queue. The bucket k > 0 counts the latencies in range
+     * [2^(k-1), 2^k), the bucket 0 counts zero latencies and the last bucket also counts all the longer latencies.
+     * The time is measured in the run time stats counter units when configGENERATE_RUN_TIME_STATS is enabled, and in
+     * ticks otherwise.
+     */
+    std::atomic<uint32_t> latency_histogram[num_latency_buckets] = {};
+};
+
+//! Hooks called by os_queue when the instrumentation is disabled. They compile to nothing.
+template <size_t N, bool Enabled> class os_queue_instrumentation
+{
+  protected:
+    void on_sent(size_t, size_t)
+    {
+    }
+
+    void on_send_rejected()
+    {
+    }
+
+    void on_received(size_t)
+    {
+    }
+};
+
+//! Hooks called by os_queue when the instrumentation is enabled.
+template <size_t N> class os_queue_instrumentation<N, true>
+{
+  protected:
+    //! Called by the producer when an element has been put to the slot and the queue holds depth elements.
+    void on_sent(size_t slot_idx, size_t depth)
+    {
+        m_enqueue_timestamps[slot_idx] = os_timestamp();
+        if (depth > m_stats.max_depth.load(std::memory_order_relaxed))
+            m_stats.max_depth.store(depth, std::memory_order_relaxed);
+    }
+
+    void on_send_rejected()
+    {
+        m_stats.num_rejected_sends.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //! Called by the consumer when the element is taken out of the slot.
+    void on_received(size_t slot_idx)
+    {
+        uint32_t latency = os_timestamp() - m_enqueue_timestamps[slot_idx];
+        size_t bucket = 0;
+        for (; latency != 0 && bucket < os_queue_stats::num_latency_buckets - 1; latency >>= 1)
+            ++bucket;
+        m_stats.latency_histogram[bucket].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    os_queue_stats m_stats;
+
+  private:
+    uint32_t m_enqueue_timestamps[N];
+};
+
+/**
+ * \brief FIFO queue which works like FreeRTOS Queue and allows to use C++ classes.
+ *
+ * The elements are kept in a ring buffer placed in an inline, properly aligned storage, thus no heap is used for the
+ * elements. The ring buffer indices are lock-free, so the kernel is touched only when the consumer must block on an
+ * empty queue and when the producer must wake up such a blocked consumer.
+ *
+ * \warning The queue is single-producer/single-consumer, unlike the former queue built on a FreeRTOS queue, which
+ * could be shared by many tasks. All the elements shall be sent by one task (or one ISR) and received by one task (or
+ * one ISR). Nothing serializes the producers nor the consumers, so a second one corrupts the queue, silently in a
+ * release build. A debug build (NDEBUG not defined) asserts that the elements are sent from a single task and
+ * received by a single task. Use os_mpmc_queue when the queue is shared by many producers or consumers.
+ *
+ * When Instrumented is true the queue gathers os_queue_stats, available through stats(). Otherwise the
+ * instrumentation costs neither memory nor time.
+ */
+template <typename T, size_t N, bool Instrumented = false>
+class os_queue : private os_queue_instrumentation<N, Instrumented>
+{
+    static_assert(N > 0, "The queue must be able to hold at least one element");
+
   public:
     explicit os_queue();
 
     ~os_queue();
 
+    os_queue(const os_queue &) = delete;
+    os_queue &operator=(const os_queue &) = delete;
+    os_queue(os_queue &&) = delete;
+    os_queue &operator=(os_queue &&) = delete;
+
     //! Returns true when the element has been sent correctly to the queue, false otherwise.
     template <typename... U> bool send(U &&... u);
 
+    //! The same as send() but callable from an ISR. The ISR must be the only producer of the queue.
+    template <typename... U> bool send_from_isr(U &&... u);
+
     //! Overwrites the element in the queue. Is only enabled when the queuen size is equal to one.
     template <size_t dim = N, class = typename std::enable_if_t<dim == 1>, typename... U> void overwrite(U &&... u);
 
     //! Either returns an element from the queue or returns false when timeout occured while awaiting for an element.
     neither::Either<T, bool> receive(TickType_t timeout);
 
+    //! Non-blocking receive callable from an ISR. The ISR must be the only consumer of the queue.
+    neither::Either<T, bool> receive_from_isr();
+
+    /**
+     * \brief Sends as many elements from the range as fit into the queue.
+     *
+     * The elements are published to the consumer at once, so the consumer is woken up at most once per call.
+     * Wrap the iterators with std::make_move_iterator() to move the elements instead of copying them.
+     *
+     * \returns The number of elements sent, counted from the beginning of the range.
+     */
+    template <typename InputIt> size_t send_n(InputIt first, InputIt last);
+
+    /**
+     * \brief Receives up to max_num elements, blocking until at least one element is available or timeout occurs.
+     *
+     * The received elements are move-assigned to the consecutive positions pointed by out.
+     *
+     * \returns The number of elements received, zero on timeout.
+     */
+    template <typename OutputIt> size_t receive_n(OutputIt out, size_t max_num, TickType_t timeout);
+
+    //! Moves all the elements currently queued to out without blocking. Returns the number of elements moved.
+    template <typename OutputIt> size_t drain(OutputIt out);
+
+    /**
+     * \brief Reserves the next free slot to construct an element in place.
+     *
+     * The element must be constructed in the returned storage, e.g. with placement new, and then published to the
+     * consumer with commit(). Until then, prepare() returns the same slot.
+     *
+     * \returns Uninitialized storage suitable for T, or nullptr when the queue is full.
+     */
+    void *prepare();
+
+    //! Publishes the element constructed in the storage returned by prepare().
+    void commit();
+
+    //! The same as commit() but callable from an ISR.
+    void commit_from_isr();
+
+    /**
+     * \brief Borrows the element at the head of the queue, blocking until it is available or timeout occurs.
+     *
+     * The element stays in the queue until release() is called, so it is not moved at all. Must not be used together
+     * with overwrite().
+     *
+     * \returns Pointer to the head element, or nullptr on timeout.
+     */
+    T *peek(TickType_t timeout);
+
+    //! Destroys the element borrowed with peek() and frees its slot.
+    void release();
+
+    //! Returns true when there is an element to receive. Used by os_wait_set.
+    bool is_ready() const;
+
+    //! Makes the queue notify the listener on each element sent. Used by os_wait_set.
+    void attach_listener(os_wait_set_listener *listener);
+
+    //! Returns the statistics gathered so far. Is only enabled when the queue is instrumented.
+    template <bool enabled = Instrumented, class = typename std::enable_if_t<enabled>>
+    const os_queue_stats &stats() const
+    {
+        return this->m_stats;
+    }
+
   private:
-    //! This vector contains elements of the queue. It's used to handle non-trivial types.
-    std::vector<T> m_queue;
+    using slot_type = std::aligned_storage_t<sizeof(T), alignof(T)>;
+
+    //! The indices run over 2 * N values, so that a full queue can be distinguished from an empty one.
+    static inline constexpr size_t index_range = 2 * N;
+
+    //! Storage of the queue's elements. The elements are constructed in place.
+    slot_type m_slots[N];
+
+    //! Index of the element which will be received next. Written only by the consumer.
+    std::atomic<size_t> m_head{0};
+
+    //! Index of the slot where the next element will be sent. Written only by the producer.
+    std::atomic<size_t> m_tail{0};
+
+    //! Set by the consumer just before it blocks on the empty queue.
+    std::atomic<bool> m_consumer_waiting{false};
+
+    //! Binary semaphore used to wake up the consumer blocked on the empty queue.
+    SemaphoreHandle_t m_not_empty_sem;
+
+    //! Listener of the os_wait_set the queue belongs to, if any.
+    std::atomic<os_wait_set_listener *> m_listener{nullptr};
+
+#ifndef NDEBUG
+    //! The task which has sent the first element. Recorded to catch a second producer.
+    std::atomic<TaskHandle_t> m_producer{nullptr};
+    //! The task which has received the first element. Recorded to catch a second consumer.
+    std::atomic<TaskHandle_t> m_consumer{nullptr};
+#endif
+
+    static size_t next_index(size_t idx);
+    static size_t num_elems(size_t head, size_t tail);
+    static size_t slot_index(size_t idx);
+
+    //! Returns the raw storage of the slot, in which an element is to be constructed.
+    void *storage(size_t idx);
+
+    //! Returns the element which lives in the slot.
+    T *slot(size_t idx);
+
+    //! Asserts in a debug build that the calling task is the only one which sends to the queue.
+    void check_single_producer();
+
+    //! Asserts in a debug build that the calling task is the only one which receives from the queue.
+    void check_single_consumer();
+
+#ifndef NDEBUG
+    //! Records the calling task as the owner of the role on the first call and asserts it on the next ones.
+    static void check_single_task(std::atomic<TaskHandle_t> &owner);
+#endif
+
+    bool is_empty() const;
+    bool wait_not_empty(TickType_t timeout);
+    template <typename... U> bool push(U &&... u);
+    void wake_consumer();
+    void wake_consumer_from_isr();
+    T pop();
+    template <typename OutputIt> size_t pop_n(OutputIt out, size_t max_num);
+
+    //! Guards the consumer's access to the only slot against overwrite(). Does nothing for bigger queues.
+    struct overwrite_guard
+    {
+        overwrite_guard()
+        {
+            if constexpr (N == 1)
+                taskENTER_CRITICAL();
+        }
+
+        ~overwrite_guard()
+        {
+            if constexpr (N == 1)
+                taskEXIT_CRITICAL();
+        }
+    };
 
-    //! Mutex which guards acces to the queue.
-    SemaphoreHandle_t m_mux;
+    //! The same as overwrite_guard, but used when the consumer is an ISR.
+    struct overwrite_guard_from_isr
+    {
+        overwrite_guard_from_isr()
+        {
+            if constexpr (N == 1)
+                saved_interrupt_status = taskENTER_CRITICAL_FROM_ISR();
+        }
+
+        ~overwrite_guard_from_isr()
+        {
+            if constexpr (N == 1)
+                taskEXIT_CRITICAL_FROM_ISR(saved_interrupt_status);
+        }
 
-    //! Counting semaphore used to count how many elements are in the queue.
-    SemaphoreHandle_t m_queue_num_elems_sem;
+        UBaseType_t saved_interrupt_status;
+    };
 };
 
-template <typename T, size_t N> os_queue<T, N>::os_queue()
+template <typename T, size_t N, bool Instrumented>
+os_queue<T, N, Instrumented>::os_queue() : m_not_empty_sem{xSemaphoreCreateBinary()}
+{
+}
+
+template <typename T, size_t N, bool Instrumented> os_queue<T, N, Instrumented>::~os_queue()
+{
+    for (auto head = m_head.load(), tail = m_tail.load(); head != tail; head = next_index(head))
+        slot(head)->~T();
+    vSemaphoreDelete(m_not_empty_sem);
+}
+
+template <typename T, size_t N, bool Instrumented>
+template <typename... U> bool os_queue<T, N, Instrumented>::send(U &&... u)
+{
+    check_single_producer();
+    if (!push(std::forward<U>(u)...))
+        return false;
+
+    wake_consumer();
+    return true;
+}
+
+template <typename T, size_t N, bool Instrumented>
+template <typename... U> bool os_queue<T, N, Instrumented>::send_from_isr(U &&... u)
+{
+    if (!push(std::forward<U>(u)...))
+        return false;
+
+    wake_consumer_from_isr();
+    return true;
+}
+
+template <typename T, size_t N, bool Instrumented>
+template <size_t dim, class, typename... U> void os_queue<T, N, Instrumented>::overwrite(U &&... u)
+{
+    // The consumer may be moving the element out of the only slot at the same time, thus both sides access the slot
+    // within a critical section. This is the only case when the queue is not lock-free.
+    check_single_producer();
+    T t(std::forward<U>(u)...);
+    bool was_empty;
+
+    taskENTER_CRITICAL();
+    auto head = m_head.load(std::memory_order_relaxed), tail = m_tail.load(std::memory_order_relaxed);
+    was_empty = head == tail;
+    if (was_empty)
+    {
+        new (storage(tail)) T(std::move(t));
+        this->on_sent(slot_index(tail), 1);
+        m_tail.store(next_index(tail));
+    }
+    else
+    {
+        *slot(head) = std::move(t);
+        this->on_sent(slot_index(head), 1);
+    }
+    taskEXIT_CRITICAL();
+
+    if (was_empty)
+        wake_consumer();
+}
+
+template <typename T, size_t N, bool Instrumented>
+neither::Either<T, bool> os_queue<T, N, Instrumented>::receive(TickType_t timeout)
 {
-    // The size is reserved once and the queue's capacity must not be changed any more.
-    m_queue.reserve(N);
-    m_mux = xSemaphoreCreateMutex();
-    m_queue_num_elems_sem = xSemaphoreCreateCounting(N, 0);
+    check_single_consumer();
+    if (!wait_not_empty(timeout))
+        return neither::right(false);
+
+    overwrite_guard g;
+    return neither::left(pop());
 }
 
-template <typename T, size_t N> os_queue<T, N>::~os_queue()
+template <typename T, size_t N, bool Instrumented>
+neither::Either<T, bool> os_queue<T, N, Instrumented>::receive_from_isr()
 {
-    vSemaphoreDelete(m_mux);
-    vSemaphoreDelete(m_queue_num_elems_sem);
+    // The producer never blocks, so there is no one to wake up.
+    if (is_empty())
+        return neither::right(false);
+
+    overwrite_guard_from_isr g;
+    return neither::left(pop());
 }
 
-template <typename T, size_t N> template <typename... U> bool os_queue<T, N>::send(U &&... u)
+template <typename T, size_t N, bool Instrumented>
+template <typename InputIt> size_t os_queue<T, N, Instrumented>::send_n(InputIt first, InputIt last)
 {
-    bool is_full = false;
+    check_single_producer();
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    auto num_queued = num_elems(m_head.load(std::memory_order_acquire), tail);
+    auto num_free = N - num_queued;
 
+    size_t num_sent = 0;
+    for (; first != last && num_sent < num_free; ++first, ++num_sent, tail = next_index(tail))
     {
-        os_lockguard guard(m_mux);
-        if (m_queue.size() == N)
-            is_full = true;
-        else
-            m_queue.emplace_back(std::forward<U>(u)...);
+        new (storage(tail)) T(*first);
+        this->on_sent(slot_index(tail), num_queued + num_sent + 1);
     }
 
-    if (!is_full)
-        assert(xSemaphoreGive(m_queue_num_elems_sem) == pdTRUE);
+    if (first != last)
+        this->on_send_rejected();
+    if (num_sent == 0)
+        return 0;
+
+    m_tail.store(tail);
+    wake_consumer();
+    return num_sent;
+}
+
+template <typename T, size_t N, bool Instrumented>
+template <typename OutputIt>
+size_t os_queue<T, N, Instrumented>::receive_n(OutputIt out, size_t max_num, TickType_t timeout)
+{
+    check_single_consumer();
+    if (max_num == 0 || !wait_not_empty(timeout))
+        return 0;
+
+    overwrite_guard g;
+    return pop_n(out, max_num);
+}
 
-    return !is_full;
+template <typename T, size_t N, bool Instrumented>
+template <typename OutputIt> size_t os_queue<T, N, Instrumented>::drain(OutputIt out)
+{
+    check_single_consumer();
+    overwrite_guard g;
+    return pop_n(out, N);
 }
 
-template <typename T, size_t N> template <size_t dim, class, typename... U> void os_queue<T, N>::overwrite(U &&... u)
+template <typename T, size_t N, bool Instrumented> void *os_queue<T, N, Instrumented>::prepare()
 {
+    check_single_producer();
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    if (num_elems(m_head.load(std::memory_order_acquire), tail) == N)
     {
-        os_lockguard guard(m_mux);
-        if (m_queue.size() == 0)
-        {
-            m_queue.emplace_back(std::forward<U>(u)...);
-        }
-        else
-        {
-            T t(std::forward<U>(u)...);
-            m_queue[0] = std::move(t);
-        }
+        this->on_send_rejected();
+        return nullptr;
     }
-    xSemaphoreGive(m_queue_num_elems_sem);
+    return storage(tail);
 }
 
-template <typename T, size_t N> neither::Either<T, bool> os_queue<T, N>::receive(TickType_t timeout)
+template <typename T, size_t N, bool Instrumented> void os_queue<T, N, Instrumented>::commit()
 {
-    if (xSemaphoreTake(m_queue_num_elems_sem, timeout) == pdFALSE)
-        return neither::right(false);
-    else
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    this->on_sent(slot_index(tail), num_elems(m_head.load(std::memory_order_acquire), tail) + 1);
+    m_tail.store(next_index(tail));
+    wake_consumer();
+}
+
+template <typename T, size_t N, bool Instrumented> void os_queue<T, N, Instrumented>::commit_from_isr()
+{
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    this->on_sent(slot_index(tail), num_elems(m_head.load(std::memory_order_acquire), tail) + 1);
+    m_tail.store(next_index(tail));
+    wake_consumer_from_isr();
+}
+
+template <typename T, size_t N, bool Instrumented> T *os_queue<T, N, Instrumented>::peek(TickType_t timeout)
+{
+    check_single_consumer();
+    if (!wait_not_empty(timeout))
+        return nullptr;
+    return slot(m_head.load(std::memory_order_relaxed));
+}
+
+template <typename T, size_t N, bool Instrumented> void os_queue<T, N, Instrumented>::release()
+{
+    auto head = m_head.load(std::memory_order_relaxed);
+    slot(head)->~T();
+    this->on_received(slot_index(head));
+    m_head.store(next_index(head), std::memory_order_release);
+}
+
+template <typename T, size_t N, bool Instrumented> bool os_queue<T, N, Instrumented>::is_ready() const
+{
+    return !is_empty();
+}
+
+template <typename T, size_t N, bool Instrumented>
+void os_queue<T, N, Instrumented>::attach_listener(os_wait_set_listener *listener)
+{
+    m_listener.store(listener);
+}
+
+template <typename T, size_t N, bool Instrumented> size_t os_queue<T, N, Instrumented>::next_index(size_t idx)
+{
+    return idx + 1 == index_range ? 0 : idx + 1;
+}
+
+template <typename T, size_t N, bool Instrumented>
+size_t os_queue<T, N, Instrumented>::num_elems(size_t head, size_t tail)
+{
+    return tail >= head ? tail - head : index_range - head + tail;
+}
+
+template <typename T, size_t N, bool Instrumented> size_t os_queue<T, N, Instrumented>::slot_index(size_t idx)
+{
+    return idx < N ? idx : idx - N;
+}
+
+template <typename T, size_t N, bool Instrumented> void *os_queue<T, N, Instrumented>::storage(size_t idx)
+{
+    return &m_slots[slot_index(idx)];
+}
+
+template <typename T, size_t N, bool Instrumented> T *os_queue<T, N, Instrumented>::slot(size_t idx)
+{
+    return std::launder(reinterpret_cast<T *>(storage(idx)));
+}
+
+template <typename T, size_t N, bool Instrumented> void os_queue<T, N, Instrumented>::check_single_producer()
+{
+#ifndef NDEBUG
+    check_single_task(m_producer);
+#endif
+}
+
+template <typename T, size_t N, bool Instrumented> void os_queue<T, N, Instrumented>::check_single_consumer()
+{
+#ifndef NDEBUG
+    check_single_task(m_consumer);
+#endif
+}
+
+#ifndef NDEBUG
+template <typename T, size_t N, bool Instrumented>
+void os_queue<T, N, Instrumented>::check_single_task(std::atomic<TaskHandle_t> &owner)
+{
+    auto current = xTaskGetCurrentTaskHandle();
+    TaskHandle_t previous = nullptr;
+    if (!owner.compare_exchange_strong(previous, current))
+        configASSERT(previous == current);
+}
+#endif
+
+template <typename T, size_t N, bool Instrumented> bool os_queue<T, N, Instrumented>::is_empty() const
+{
+    return m_head.load(std::memory_order_relaxed) == m_tail.load();
+}
+
+template <typename T, size_t N, bool Instrumented> bool os_queue<T, N, Instrumented>::wait_not_empty(TickType_t timeout)
+{
+    if (!is_empty())
+        return true;
+
+    TimeOut_t timeout_state;
+    vTaskSetTimeOutState(&timeout_state);
+    while (true)
+    {
+        // The flag must be visible to the producer before the emptiness is checked again. Otherwise the producer
+        // could miss the consumer which is going to block.
+        m_consumer_waiting.store(true);
+        if (!is_empty())
+            break;
+
+        if (xSemaphoreTake(m_not_empty_sem, timeout) == pdFALSE)
+            break;
+
+        // The semaphore may hold a stale wake-up given after the previous wait had already finished.
+        if (!is_empty() || xTaskCheckForTimeOut(&timeout_state, &timeout) == pdTRUE)
+            break;
+    }
+    m_consumer_waiting.store(false);
+    return !is_empty();
+}
+
+template <typename T, size_t N, bool Instrumented>
+template <typename... U> bool os_queue<T, N, Instrumented>::push(U &&... u)
+{
+    auto tail = m_tail.load(std::memory_order_relaxed);
+    auto num_queued = num_elems(m_head.load(std::memory_order_acquire), tail);
+    if (num_queued == N)
+    {
+        this->on_send_rejected();
+        return false;
+    }
+
+    new (storage(tail)) T(std::forward<U>(u)...);
+    this->on_sent(slot_index(tail), num_queued + 1);
+    m_tail.store(next_index(tail));
+    return true;
+}
+
+template <typename T, size_t N, bool Instrumented> void os_queue<T, N, Instrumented>::wake_consumer()
+{
+    if (m_consumer_waiting.exchange(false))
+        xSemaphoreGive(m_not_empty_sem);
+    if (auto listener = m_listener.load())
+        listener->notify();
+}
+
+template <typename T, size_t N, bool Instrumented> void os_queue<T, N, Instrumented>::wake_consumer_from_isr()
+{
+    if (m_consumer_waiting.exchange(false))
+    {
+        BaseType_t higher_prior_task_woken = pdFALSE;
+        xSemaphoreGiveFromISR(m_not_empty_sem, &higher_prior_task_woken);
+        portEND_SWITCHING_ISR(higher_prior_task_woken);
+    }
+    if (auto listener = m_listener.load())
+        listener->notify_from_isr();
+}
+
+template <typename T, size_t N, bool Instrumented> T os_queue<T, N, Instrumented>::pop()
+{
+    auto head = m_head.load(std::memory_order_relaxed);
+    auto elem = slot(head);
+    T res(std::move(*elem));
+    elem->~T();
+    this->on_received(slot_index(head));
+    m_head.store(next_index(head), std::memory_order_release);
+    return res;
+}
+
+template <typename T, size_t N, bool Instrumented>
+template <typename OutputIt> size_t os_queue<T, N, Instrumented>::pop_n(OutputIt out, size_t max_num)
+{
+    auto head = m_head.load(std::memory_order_relaxed);
+    auto num = std::min(max_num, num_elems(head, m_tail.load(std::memory_order_acquire)));
+
+    for (size_t i = 0; i < num; ++i, head = next_index(head))
     {
-        os_lockguard guard(m_mux);
-        auto res = std::move(m_queue[m_queue.size() - 1]);
-        m_queue.pop_back();
-        return neither::left(static_cast<T>(res));
+        auto elem = slot(head);
+        *out++ = std::move(*elem);
+        elem->~T();
+        this->on_received(slot_index(head));
     }
+
+    // All the slots are handed back to the producer at once.
+    m_head.store(head, std::memory_order_release);
+    return num;
 }
 
 } // namespace jungles
 
 #endif /* OS_QUEUE_HPP */
-
@@ -0,0 +1,345 @@
+/**
+ * @file	os_rx_line_buffer.hpp
+ * @brief	Ring buffer which splits a received byte stream into lines or binary frames.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_RX_LINE_BUFFER_HPP
+#define OS_RX_LINE_BUFFER_HPP
+
+#include "os_framing.hpp"
+#include <algorithm>
+#include <atomic>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace jungles {
+
+/**
+ * \brief Splits a byte stream into lines, which are stored back to back in an inline ring buffer.
+ *
+ * Bytes are pushed (typically from an ISR) and complete lines are popped by a single consumer at a time. The Framing
+ * decodes the bytes and tells where the lines end (see os_frame_event). By default the stream is split into text lines
+ * (see os_line_framing), but binary frames can be received the same way, e.g. with os_slip_framing or os_cobs_framing.
+ * Empty lines are never stored.
+ *
+ * When the buffer is full, the incoming bytes are dropped, thus the line is truncated (or dropped, depending on the
+ * framing). When there is no room for another line, the line being completed is dropped.
+ */
+template <size_t BufSize, size_t MaxNumLines, typename Framing = os_line_framing> class os_rx_line_buffer
+{
+    static_assert(BufSize > 0 && MaxNumLines > 0, "The buffer must be able to hold at least one line");
+
+  public:
+    explicit os_rx_line_buffer(Framing framing = Framing());
+
+    os_rx_line_buffer(const os_rx_line_buffer &) = delete;
+    os_rx_line_buffer &operator=(const os_rx_line_buffer &) = delete;
+    os_rx_line_buffer(os_rx_line_buffer &&) = delete;
+    os_rx_line_buffer &operator=(os_rx_line_buffer &&) = delete;
+
+    //! Called by the producer. Returns true when the byte has completed a line.
+    bool push_byte_and_is_string_end(char c);
+
+    /**
+     * \brief Called by the producer to push a burst of bytes, e.g. a DMA transfer or the bytes received till an idle
+     * line interrupt.
+     *
+     * Works like calling push_byte_and_is_string_end() for each of the bytes, but the runs of plain data, e.g. the
+     * bytes between the terminators, are located a machine word at a time and copied in bulk.
+     *
+     * \returns The number of lines completed by the burst.
+     */
+    size_t push_bytes_and_count_string_ends(const char *data, size_t len);
+
+    /**
+     * \brief Pops the oldest complete line to the caller's buffer.
+     *
+     * When the line is longer than the buffer, the rest of the line is discarded. The line is not null-terminated.
+     *
+     * \returns The number of bytes copied to the buffer, zero when there is no complete line.
+     */
+    size_t pop_line(char *out, size_t out_size);
+
+    //! Pops the oldest complete line to a newly allocated string. Returns an empty string when there is no line.
+    std::string pop_string();
+
+    bool has_line() const;
+
+    //! Number of bytes held by the buffer, including the line being received.
+    size_t num_used_bytes() const;
+
+    //! Number of complete lines held by the buffer.
+    size_t num_lines() const;
+
+    //! Number of bytes dropped because the buffer was full.
+    size_t num_dropped_bytes() const;
+
+    //! Number of lines dropped because there was no room for them, or because they were malformed or truncated.
+    size_t num_dropped_lines() const;
+
+  private:
+    //! The indices run over twice the size of the corresponding buffer, so that a full buffer can be distinguished
+    //! from an empty one.
+    static inline constexpr size_t byte_index_range = 2 * BufSize;
+    static inline constexpr size_t line_index_range = 2 * MaxNumLines;
+
+    Framing m_framing;
+
+    char m_buf[BufSize];
+
+    //! Byte index where each of the complete lines ends.
+    size_t m_line_ends[MaxNumLines];
+
+    //! Index of the first byte of the oldest complete line. Written only by the consumer.
+    std::atomic<size_t> m_read_idx{0};
+
+    //! Index of the oldest complete line. Written only by the consumer.
+    std::atomic<size_t> m_lines_head{0};
+
+    //! Index where the next complete line will be stored. Written only by the producer.
+    std::atomic<size_t> m_lines_tail{0};
+
+    //! Index of the first byte of the line being received. Used only by the producer.
+    size_t m_line_start_idx{0};
+
+    //! Index where the next byte will be stored. Used only by the producer.
+    size_t m_write_idx{0};
+
+    //! Set when a byte of the line being received has been dropped. Used only by the producer.
+    bool m_is_truncated{false};
+
+    //! Written only by the producer.
+    std::atomic<size_t> m_num_dropped_bytes{0};
+    std::atomic<size_t> m_num_dropped_lines{0};
+
+    static size_t distance(size_t from, size_t to, size_t range);
+    static size_t advance(size_t idx, size_t n, size_t range);
+    static size_t offset(size_t idx);
+
+    void store_byte(char c);
+    void store_bytes(const char *data, size_t len);
+    bool end_line();
+    void drop_line();
+    bool complete_line();
+
+    //! Calls copy(const char *, size_t) for each contiguous part of the oldest line and frees the line.
+    template <typename Copy> void consume_line(Copy &&copy);
+};
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+os_rx_line_buffer<BufSize, MaxNumLines, Framing>::os_rx_line_buffer(Framing framing) : m_framing{std::move(framing)}
+{
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+bool os_rx_line_buffer<BufSize, MaxNumLines, Framing>::push_byte_and_is_string_end(char c)
+{
+    switch (m_framing.decode(c, m_write_idx == m_line_start_idx))
+    {
+    case os_frame_event::none:
+        return false;
+    case os_frame_event::data:
+        store_byte(c);
+        return false;
+    case os_frame_event::end:
+        return end_line();
+    case os_frame_event::data_and_end:
+        store_byte(c);
+        return end_line();
+    case os_frame_event::error:
+        drop_line();
+        return false;
+    }
+    return false;
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::push_bytes_and_count_string_ends(const char *data,
+                                                                                          size_t len)
+{
+    size_t num_lines = 0;
+    auto end = data + len;
+    while (data != end)
+    {
+        if (auto n = m_framing.consume_data_run(data, end, m_write_idx == m_line_start_idx); n > 0)
+        {
+            store_bytes(data, n);
+            data += n;
+        }
+        else
+        {
+            num_lines += push_byte_and_is_string_end(*data++);
+        }
+    }
+    return num_lines;
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::pop_line(char *out, size_t out_size)
+{
+    size_t num_copied = 0;
+    consume_line([&](const char *part, size_t len) {
+        auto n = std::min(len, out_size - num_copied);
+        std::copy_n(part, n, out + num_copied);
+        num_copied += n;
+    });
+    return num_copied;
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+std::string os_rx_line_buffer<BufSize, MaxNumLines, Framing>::pop_string()
+{
+    std::string res;
+    consume_line([&](const char *part, size_t len) { res.append(part, len); });
+    return res;
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+bool os_rx_line_buffer<BufSize, MaxNumLines, Framing>::has_line() const
+{
+    return m_lines_head.load(std::memory_order_relaxed) != m_lines_tail.load();
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::num_used_bytes() const
+{
+    return distance(m_read_idx.load(std::memory_order_relaxed), m_write_idx, byte_index_range);
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::num_lines() const
+{
+    return distance(m_lines_head.load(std::memory_order_relaxed), m_lines_tail.load(), line_index_range);
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::num_dropped_bytes() const
+{
+    return m_num_dropped_bytes.load(std::memory_order_relaxed);
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::num_dropped_lines() const
+{
+    return m_num_dropped_lines.load(std::memory_order_relaxed);
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::distance(size_t from, size_t to, size_t range)
+{
+    return to >= from ? to - from : range - from + to;
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::advance(size_t idx, size_t n, size_t range)
+{
+    idx += n;
+    return idx >= range ? idx - range : idx;
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+size_t os_rx_line_buffer<BufSize, MaxNumLines, Framing>::offset(size_t idx)
+{
+    return idx < BufSize ? idx : idx - BufSize;
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+void os_rx_line_buffer<BufSize, MaxNumLines, Framing>::store_byte(char c)
+{
+    if (distance(m_read_idx.load(std::memory_order_acquire), m_write_idx, byte_index_range) == BufSize)
+    {
+        m_is_truncated = true;
+        m_num_dropped_bytes.fetch_add(1, std::memory_order_relaxed);
+        return;
+    }
+
+    m_buf[offset(m_write_idx)] = c;
+    m_write_idx = advance(m_write_idx, 1, byte_index_range);
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+void os_rx_line_buffer<BufSize, MaxNumLines, Framing>::store_bytes(const char *data, size_t len)
+{
+    auto num_free = BufSize - distance(m_read_idx.load(std::memory_order_acquire), m_write_idx, byte_index_range);
+    auto n = std::min(len, num_free);
+    if (n < len)
+    {
+        m_is_truncated = true;
+        m_num_dropped_bytes.fetch_add(len - n, std::memory_order_relaxed);
+    }
+
+    // The free space may wrap around the end of the buffer.
+    auto first_part = std::min(n, BufSize - offset(m_write_idx));
+    std::copy_n(data, first_part, m_buf + offset(m_write_idx));
+    std::copy_n(data + first_part, n - first_part, m_buf);
+    m_write_idx = advance(m_write_idx, n, byte_index_range);
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+bool os_rx_line_buffer<BufSize, MaxNumLines, Framing>::end_line()
+{
+    // Skipping an empty line is not a drop, unless all of its bytes have been dropped.
+    if (m_write_idx == m_line_start_idx && !m_is_truncated)
+        return false;
+
+    if (m_write_idx == m_line_start_idx || (m_is_truncated && !Framing::keeps_truncated_frames))
+    {
+        drop_line();
+        return false;
+    }
+
+    m_is_truncated = false;
+    return complete_line();
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+void os_rx_line_buffer<BufSize, MaxNumLines, Framing>::drop_line()
+{
+    // The bytes of the line are given back.
+    m_write_idx = m_line_start_idx;
+    m_is_truncated = false;
+    m_num_dropped_lines.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+bool os_rx_line_buffer<BufSize, MaxNumLines, Framing>::complete_line()
+{
+    auto tail = m_lines_tail.load(std::memory_order_relaxed);
+    if (distance(m_lines_head.load(std::memory_order_acquire), tail, line_index_range) == MaxNumLines)
+    {
+        drop_line();
+        return false;
+    }
+
+    m_line_ends[tail < MaxNumLines ? tail : tail - MaxNumLines] = m_write_idx;
+    m_line_start_idx = m_write_idx;
+    m_lines_tail.store(advance(tail, 1, line_index_range), std::memory_order_release);
+    return true;
+}
+
+template <size_t BufSize, size_t MaxNumLines, typename Framing>
+template <typename Copy>
+void os_rx_line_buffer<BufSize, MaxNumLines, Framing>::consume_line(Copy &&copy)
+{
+    auto head = m_lines_head.load(std::memory_order_relaxed);
+    if (head == m_lines_tail.load(std::memory_order_acquire))
+        return;
+
+    auto beg = m_read_idx.load(std::memory_order_relaxed);
+    auto end = m_line_ends[head < MaxNumLines ? head : head - MaxNumLines];
+    auto len = distance(beg, end, byte_index_range);
+
+    // The line may wrap around the end of the buffer.
+    auto first_part = std::min(len, BufSize - offset(beg));
+    copy(m_buf + offset(beg), first_part);
+    if (len > first_part)
+        copy(m_buf, len - first_part);
+
+    m_read_idx.store(end, std::memory_order_release);
+    m_lines_head.store(advance(head, 1, line_index_range), std::memory_order_release);
+}
+
+} // namespace jungles
+
+#endif /* OS_RX_LINE_BUFFER_HPP */
@@ -0,0 +1,106 @@
+/**
+ * @file	os_static_task.hpp
+ * @brief	Definition of a wrapper for FreeRTOS task which does not use the heap.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_STATIC_TASK_HPP
+#define OS_STATIC_TASK_HPP
+
+#include "os.h"
+#include <cstddef>
+#include <type_traits>
+#include <utility>
+
+namespace jungles {
+
+/**
+ * \brief Works like os_task, but the stack, the task control block and the task code are stored within the object.
+ *
+ * The task is created with os_task_create_static(), so creating it never allocates and the memory used by the task
+ * is known at link time, e.g. when the object is a global or a static variable. The task code is stored as an object
+ * of type TaskCode, which is a pointer to a function by default:
+ *
+ *      static os_static_task<256> task(&task_code, "task", 1);
+ *
+ * Use make_os_static_task() to store a lambda:
+ *
+ *      static auto task = make_os_static_task<256>([&ctx]() { ... }, "task", 1);
+ *
+ * The object must outlive the task, so it is deleted on destruction, as os_task is.
+ *
+ * \tparam StackWords   The size of the stack in words (os_stack_type_t).
+ * \tparam TaskCode     The type of the functional object with signature void(void).
+ */
+template <size_t StackWords, typename TaskCode = void (*)(void)> class os_static_task
+{
+  public:
+    /**
+     *	\brief The constructor of os_static_task.
+     *	\param[in] task_code		The code of the task.
+     *	\param[in] name				The name of the task; copied by the OS to the task control block.
+     *	\param[in] priority			The priority of the task.
+     */
+    template <typename TaskFuncType>
+    os_static_task(TaskFuncType &&task_code, const char *name, os_base_type_t priority);
+
+    os_static_task(const os_static_task &) = delete;
+    os_static_task &operator=(const os_static_task &) = delete;
+    os_static_task(os_static_task &&) = delete;
+    os_static_task &operator=(os_static_task &&) = delete;
+    ~os_static_task();
+
+  private:
+    //! The task handle must be stored to delete the task on destruction.
+    os_task_handle_t task_handle;
+
+    //! The functional object which stores the task code.
+    TaskCode task_code;
+
+    os_static_task_t tcb;
+    os_stack_type_t stack[StackWords];
+};
+
+/**
+ * \brief Creates os_static_task which stores the functional object, e.g. a lambda, without type erasure.
+ *
+ * Relies on the guaranteed copy elision, so the returned task is constructed in place, e.g.:
+ *
+ *      static auto task = make_os_static_task<256>([]() { ... }, "task", 1);
+ */
+template <size_t StackWords, typename TaskFuncType>
+os_static_task<StackWords, std::decay_t<TaskFuncType>>
+make_os_static_task(TaskFuncType &&task_code, const char *name, os_base_type_t priority)
+{
+    return {std::forward<TaskFuncType>(task_code), name, priority};
+}
+
+template <size_t StackWords, typename TaskCode>
+template <typename TaskFuncType>
+os_static_task<StackWords, TaskCode>::os_static_task(TaskFuncType &&task_code,
+                                                     const char *name,
+                                                     os_base_type_t priority)
+    : task_code(std::forward<TaskFuncType>(task_code))
+{
+    task_handle = os_task_create_static(
+        [](void *p) {
+            // The parameter passed to the task code is a pointer to this object.
+            auto os_task_p = static_cast<os_static_task *>(p);
+            os_task_p->task_code();
+            os_delay_ms(os_no_timeout);
+        },
+        name,
+        StackWords,
+        this,
+        priority,
+        stack,
+        &tcb);
+}
+
+template <size_t StackWords, typename TaskCode> os_static_task<StackWords, TaskCode>::~os_static_task()
+{
+    os_task_delete(task_handle);
+}
+
+} // namespace jungles
+
+#endif /* OS_STATIC_TASK_HPP */
@@ -7,7 +7,8 @@
 #define OS_TASK_HPP
 
 #include "os.h"
-#include <functional>
+#include "os_function.hpp"
+#include <string>
 
 namespace jungles {
 /**
@@ -15,7 +16,8 @@ namespace jungles {
  *
  * This wrapper allows to pass any functional object to os_task_create() but the final signature must be
  * void(void). This means that any arguments passed to the functional object must be bind at the moment of creating an
- * instance of this class.
+ * instance of this class. The functional object is stored in os_function, so it must not be bigger than
+ * os_function_default_capacity, e.g. a lambda may capture up to four references.
  */
 class os_task
 {
@@ -26,9 +28,14 @@ class os_task
      *	\param[in] name				The name of the task.
      *	\param[in] stack_size		The size of the stack allocated for the task.
      *	\param[in] priority			The priority of the task.
+     *	\param[in] core_affinity	The cores the task may run on, e.g. os_core_affinity_of(1); see set_core_affinity().
      */
     template <typename TaskFuncType>
-    os_task(TaskFuncType &&task_code, std::string name, unsigned short stack_size, os_base_type_t priority);
+    os_task(TaskFuncType &&task_code,
+            std::string name,
+            unsigned short stack_size,
+            os_base_type_t priority,
+            os_core_affinity_mask_t core_affinity = os_core_affinity_any);
 
     os_task(const os_task &) = delete;
     os_task &operator=(const os_task &) = delete;
@@ -36,19 +43,49 @@ class os_task
     os_task &operator=(os_task &&) = delete;
     ~os_task();
 
+    os_task_handle_t get_handle() const;
+
+    /**
+     * \brief Restricts the cores the task may run on to the ones set in the mask.
+     *
+     * Works only with the FreeRTOS SMP kernel built with configUSE_CORE_AFFINITY (see os_has_core_affinity). Otherwise
+     * the task runs on the only core and the mask is ignored.
+     */
+    void set_core_affinity(os_core_affinity_mask_t core_affinity);
+
+    os_core_affinity_mask_t get_core_affinity() const;
+
+    /**
+     * \brief Hints that the task shall run on the same core as the other task, e.g. when they share an os_queue.
+     *
+     * Keeps the data passed between the tasks in the cache of a single core and avoids the migrations. Both tasks are
+     * pinned to the given core when it is allowed for both of them, which is always the case when neither task is
+     * pinned. Thus the caller spreads the colocated pairs over the cores, instead of all of them ending up on the same
+     * core. When the core is not allowed for both tasks, they are pinned to the lowest core which is. When there is no
+     * such core, this task is restricted to the cores of the other task.
+     *
+     * \param[in] other	The task to run with.
+     * \param[in] core	The preferred core, below os_num_cores.
+     */
+    void colocate_with(os_task &other, unsigned core);
+
   private:
     //! The task handle must be stored to delete the task on destruction.
     os_task_handle_t task_handle;
 
-    //! The functional object which stores the task code.
-    std::function<void(void)> task_code;
+    //! The functional object which stores the task code; never allocates, see os_function.
+    os_function<void(void)> task_code;
 };
 
 template <typename TaskFuncType>
-os_task::os_task(TaskFuncType &&task_code, std::string name, unsigned short stack_size, os_base_type_t priority)
+os_task::os_task(TaskFuncType &&task_code,
+                 std::string name,
+                 unsigned short stack_size,
+                 os_base_type_t priority,
+                 os_core_affinity_mask_t core_affinity)
     : task_code(std::forward<TaskFuncType>(task_code))
 {
-    os_task_create(
+    os_task_create_affinity(
         [](void *p) {
             // The parameter passed to the task code is a pointer to this object.
             auto os_task_p = static_cast<os_task *>(p);
@@ -61,14 +98,45 @@ os_task::os_task(TaskFuncType &&task_code, std::string name, unsigned short stac
         // object to have acces the task code when the task is executed.
         this,
         priority,
+        core_affinity,
         &task_handle);
 }
 
-os_task::~os_task()
+inline os_task::~os_task()
 {
     os_task_delete(task_handle);
 }
 
+inline os_task_handle_t os_task::get_handle() const
+{
+    return task_handle;
+}
+
+inline void os_task::set_core_affinity(os_core_affinity_mask_t core_affinity)
+{
+    os_task_set_core_affinity(task_handle, core_affinity);
+}
+
+inline os_core_affinity_mask_t os_task::get_core_affinity() const
+{
+    return os_task_get_core_affinity(task_handle);
+}
+
+inline void os_task::colocate_with(os_task &other, unsigned core)
+{
+    auto shared = get_core_affinity() & other.get_core_affinity();
+    if (shared == 0)
+    {
+        set_core_affinity(other.get_core_affinity());
+        return;
+    }
+
+    auto preferred = os_core_affinity_of(core);
+    auto pinned = (shared & preferred) ? preferred : shared & (~shared + 1);
+    other.set_core_affinity(pinned);
+    set_core_affinity(pinned);
+}
+
 } // namespace jungles
 
 #endif /* OS_TASK_HPP */
@@ -0,0 +1,202 @@
+/**
+ * @file	os_wait_set.hpp
+ * @brief	Allows a task to block on multiple queues and flags at once.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#ifndef OS_WAIT_SET_HPP
+#define OS_WAIT_SET_HPP
+
+#include "FreeRTOS.h"
+#include "neither/neither.hpp"
+#include "semphr.h"
+#include "task.h"
+#include <atomic>
+
+namespace jungles {
+
+/**
+ * \brief Endpoint through which the members of os_wait_set wake up the task waiting on the set.
+ *
+ * A member calls notify() every time it might have become ready, e.g. after an element has been sent to a queue. The
+ * kernel is touched only when the waiting task is about to block.
+ */
+class os_wait_set_listener
+{
+  public:
+    os_wait_set_listener() : m_wake_sem{xSemaphoreCreateBinary()}
+    {
+    }
+
+    ~os_wait_set_listener()
+    {
+        vSemaphoreDelete(m_wake_sem);
+    }
+
+    os_wait_set_listener(const os_wait_set_listener &) = delete;
+    os_wait_set_listener &operator=(const os_wait_set_listener &) = delete;
+    os_wait_set_listener(os_wait_set_listener &&) = delete;
+    os_wait_set_listener &operator=(os_wait_set_listener &&) = delete;
+
+    void notify()
+    {
+        if (m_waiting.exchange(false))
+            xSemaphoreGive(m_wake_sem);
+    }
+
+    void notify_from_isr()
+    {
+        if (m_waiting.exchange(false))
+        {
+            BaseType_t higher_prior_task_woken = pdFALSE;
+            xSemaphoreGiveFromISR(m_wake_sem, &higher_prior_task_woken);
+            portEND_SWITCHING_ISR(higher_prior_task_woken);
+        }
+    }
+
+    /**
+     * \brief Makes notify() wake up the waiting task. Called by the waiting task, which shall check the awaited
+     * objects once more afterwards and only then block().
+     *
+     * The flag must be visible to the notifiers before the objects are checked. Otherwise a notifier could miss the
+     * task which is going to block.
+     */
+    void arm()
+    {
+        m_waiting.store(true);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    //! Blocks until notify() or timeout. Returns false on timeout. The wake-up may be stale, so it is only a hint.
+    bool block(TickType_t timeout)
+    {
+        return xSemaphoreTake(m_wake_sem, timeout) == pdTRUE;
+    }
+
+    //! Called by the waiting task when it stops waiting.
+    void disarm()
+    {
+        m_waiting.store(false);
+    }
+
+  private:
+    //! Set by the waiting task before it checks the awaited objects for the last time and blocks.
+    std::atomic<bool> m_waiting{false};
+
+    //! Binary semaphore the waiting task blocks on.
+    SemaphoreHandle_t m_wake_sem;
+};
+
+/**
+ * \brief Blocks a task until any of the added members becomes ready, like select() does for file descriptors.
+ *
+ * Any object which provides the methods below can be added to the set (os_queue and os_flag do):
+ *
+ *      bool is_ready();                                    // Returns true when the object can be consumed.
+ *      void attach_listener(os_wait_set_listener *);       // nullptr detaches the listener.
+ *
+ * A member can belong to at most one set at a time and must outlive the set. Only one task may wait() on the set.
+ */
+template <size_t MaxNumMembers> class os_wait_set
+{
+  public:
+    os_wait_set() = default;
+
+    ~os_wait_set()
+    {
+        for (size_t i = 0; i < m_num_members; ++i)
+            m_members[i].attach_listener(m_members[i].object, nullptr);
+    }
+
+    os_wait_set(const os_wait_set &) = delete;
+    os_wait_set &operator=(const os_wait_set &) = delete;
+    os_wait_set(os_wait_set &&) = delete;
+    os_wait_set &operator=(os_wait_set &&) = delete;
+
+    //! Adds the member to the set. Returns the index under which wait() reports the member.
+    template <typename Waitable> size_t add(Waitable &waitable);
+
+    /**
+     * \brief Blocks until any member is ready or timeout occurs.
+     *
+     * The members are checked starting after the one returned last time, so that a busy member does not starve the
+     * others. The returned member is only reported as ready; it must be consumed (e.g. with receive(0)) by the caller.
+     *
+     * \returns Either the index of a ready member or false on timeout.
+     */
+    neither::Either<size_t, bool> wait(TickType_t timeout);
+
+  private:
+    struct member
+    {
+        void *object;
+        bool (*is_ready)(void *object);
+        void (*attach_listener)(void *object, os_wait_set_listener *listener);
+    };
+
+    static inline constexpr size_t no_member = MaxNumMembers;
+
+    member m_members[MaxNumMembers];
+    size_t m_num_members{0};
+    size_t m_last_ready{MaxNumMembers - 1};
+    os_wait_set_listener m_listener;
+
+    size_t find_ready();
+};
+
+template <size_t MaxNumMembers> template <typename Waitable> size_t os_wait_set<MaxNumMembers>::add(Waitable &waitable)
+{
+    configASSERT(m_num_members < MaxNumMembers);
+
+    m_members[m_num_members] = member{
+        &waitable,
+        [](void *object) { return static_cast<Waitable *>(object)->is_ready(); },
+        [](void *object, os_wait_set_listener *listener) {
+            static_cast<Waitable *>(object)->attach_listener(listener);
+        },
+    };
+    waitable.attach_listener(&m_listener);
+    return m_num_members++;
+}
+
+template <size_t MaxNumMembers> neither::Either<size_t, bool> os_wait_set<MaxNumMembers>::wait(TickType_t timeout)
+{
+    TimeOut_t timeout_state;
+    vTaskSetTimeOutState(&timeout_state);
+
+    size_t ready;
+    while (true)
+    {
+        m_listener.arm();
+        if ((ready = find_ready()) != no_member)
+            break;
+
+        // The semaphore may hold a stale wake-up, thus the members are checked again in such case.
+        if (!m_listener.block(timeout) || xTaskCheckForTimeOut(&timeout_state, &timeout) == pdTRUE)
+        {
+            ready = find_ready();
+            break;
+        }
+    }
+    m_listener.disarm();
+
+    if (ready == no_member)
+        return neither::right(false);
+
+    m_last_ready = ready;
+    return neither::left(static_cast<size_t>(ready));
+}
+
+template <size_t MaxNumMembers> size_t os_wait_set<MaxNumMembers>::find_ready()
+{
+    for (size_t i = 1; i <= m_num_members; ++i)
+    {
+        auto idx = (m_last_ready + i) % m_num_members;
+        if (m_members[idx].is_ready(m_members[idx].object))
+            return idx;
+    }
+    return no_member;
+}
+
+} // namespace jungles
+
+#endif /* OS_WAIT_SET_HPP */
@@ -0,0 +1,37 @@
+/**
+ * @file	freertos_static_memory.cpp
+ * @brief	Provides the memory of the idle and the timer task, required by configSUPPORT_STATIC_ALLOCATION.
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "FreeRTOS.h"
+#include "task.h"
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+static StaticTask_t idle_task_tcb;
+static StackType_t idle_task_stack[configMINIMAL_STACK_SIZE];
+
+static StaticTask_t timer_task_tcb;
+static StackType_t timer_task_stack[configTIMER_TASK_STACK_DEPTH];
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PUBLIC FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+extern "C" void vApplicationGetIdleTaskMemory(StaticTask_t **ppxIdleTaskTCBBuffer,
+                                              StackType_t **ppxIdleTaskStackBuffer,
+                                              uint32_t *pulIdleTaskStackSize)
+{
+    *ppxIdleTaskTCBBuffer = &idle_task_tcb;
+    *ppxIdleTaskStackBuffer = idle_task_stack;
+    *pulIdleTaskStackSize = configMINIMAL_STACK_SIZE;
+}
+
+extern "C" void vApplicationGetTimerTaskMemory(StaticTask_t **ppxTimerTaskTCBBuffer,
+                                               StackType_t **ppxTimerTaskStackBuffer,
+                                               uint32_t *pulTimerTaskStackSize)
+{
+    *ppxTimerTaskTCBBuffer = &timer_task_tcb;
+    *ppxTimerTaskStackBuffer = timer_task_stack;
+    *pulTimerTaskStackSize = configTIMER_TASK_STACK_DEPTH;
+}
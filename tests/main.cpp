@@ -8,6 +8,19 @@
 #include "unity.h"
 
 extern void test_os_char_driver();
+extern void test_os_queue();
+extern void test_os_mpmc_queue();
+extern void test_os_priority_queue();
+extern void test_os_wait_set();
+extern void test_os_line_dispatcher();
+extern void test_os_char_mux();
+extern void test_os_static_task();
+extern void test_os_function();
+extern void test_os_executor();
+extern void test_os_task();
+extern void test_os_periodic_task();
+extern void test_os_profiler();
+extern void test_os_coroutine();
 
 int main()
 {
@@ -16,6 +29,19 @@ int main()
     xTaskCreate(
         [](void *) {
             test_os_char_driver();
+            test_os_queue();
+            test_os_mpmc_queue();
+            test_os_priority_queue();
+            test_os_wait_set();
+            test_os_line_dispatcher();
+            test_os_char_mux();
+            test_os_static_task();
+            test_os_function();
+            test_os_executor();
+            test_os_task();
+            test_os_periodic_task();
+            test_os_profiler();
+            test_os_coroutine();
 
             vTaskEndScheduler();
         },
@@ -4,8 +4,10 @@
  * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
  */
 #include "os_char_driver.hpp"
+#include "os_flag.hpp"
 #include "os_task.hpp"
 #include "unity.h"
+#include <algorithm>
 #include <array>
 #include <csignal>
 #include <functional>
@@ -23,15 +25,29 @@ using namespace jungles;
 // --------------------------------------------------------------------------------------------------------------------
 static void UNIT_TEST_1_block_on_read_and_unblock_on_message_received();
 static void UNIT_TEST_2_blocking_write_multiple_string_types();
+static void UNIT_TEST_3_blocking_write_with_chunk_sender();
+static void UNIT_TEST_4_buffered_write_returns_before_transmission();
+static void UNIT_TEST_5_buffered_write_full_buffer_policies();
+static void UNIT_TEST_6_readline_to_caller_buffer();
+static void UNIT_TEST_7_write_while_other_task_blocks_on_readline();
+static void UNIT_TEST_8_burst_rx_matches_bytewise_rx();
+static void UNIT_TEST_9_slip_frames_loopback();
+static void UNIT_TEST_10_cobs_frames_loopback();
+static void UNIT_TEST_11_rx_loss_accounting_and_flow_control();
+static void UNIT_TEST_12_buffered_write_stops_at_truncated_string();
+static void UNIT_TEST_13_buffered_write_does_not_overwrite_chunk_in_flight();
+static void UNIT_TEST_14_unbuffered_frame_parts_are_written_in_chunks();
 
 // --------------------------------------------------------------------------------------------------------------------
 // DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
 // --------------------------------------------------------------------------------------------------------------------
 static std::function<void(void)> tx_isr_handler, rx_isr_handler;
 static std::function<void(char)> byte_sender;
+static std::function<size_t(const char *, size_t)> chunk_sender;
 static void helper_set_tx_isr_handler(std::function<void(void)> f);
 static void helper_set_rx_isr_handler(std::function<void(void)> f);
 static void helper_set_byte_sender(std::function<void(char)> f);
+static void helper_set_chunk_sender(std::function<size_t(const char *, size_t)> f);
 
 static bool tx_isr_enabled;
 static void tx_isr_handler_callback(int signal);
@@ -40,7 +56,11 @@ static void tx_it_enable();
 static void tx_it_disable();
 static void rx_it_enable();
 static void rx_it_disable();
+static bool is_rx_stopped;
+static void rx_stop();
+static void rx_resume();
 static void byte_send(char c);
+static size_t chunk_send(const char *data, size_t len);
 
 // --------------------------------------------------------------------------------------------------------------------
 // EXECUTION OF THE TESTS
@@ -52,6 +72,18 @@ void test_os_char_driver()
 
     RUN_TEST(UNIT_TEST_1_block_on_read_and_unblock_on_message_received);
     RUN_TEST(UNIT_TEST_2_blocking_write_multiple_string_types);
+    RUN_TEST(UNIT_TEST_3_blocking_write_with_chunk_sender);
+    RUN_TEST(UNIT_TEST_4_buffered_write_returns_before_transmission);
+    RUN_TEST(UNIT_TEST_5_buffered_write_full_buffer_policies);
+    RUN_TEST(UNIT_TEST_6_readline_to_caller_buffer);
+    RUN_TEST(UNIT_TEST_7_write_while_other_task_blocks_on_readline);
+    RUN_TEST(UNIT_TEST_8_burst_rx_matches_bytewise_rx);
+    RUN_TEST(UNIT_TEST_9_slip_frames_loopback);
+    RUN_TEST(UNIT_TEST_10_cobs_frames_loopback);
+    RUN_TEST(UNIT_TEST_11_rx_loss_accounting_and_flow_control);
+    RUN_TEST(UNIT_TEST_12_buffered_write_stops_at_truncated_string);
+    RUN_TEST(UNIT_TEST_13_buffered_write_does_not_overwrite_chunk_in_flight);
+    RUN_TEST(UNIT_TEST_14_unbuffered_frame_parts_are_written_in_chunks);
 
     std::signal(SIGNAL_TX, SIG_DFL);
     std::signal(SIGNAL_RX, SIG_DFL);
@@ -114,6 +146,340 @@ static void UNIT_TEST_2_blocking_write_multiple_string_types()
     TEST_ASSERT_EQUAL_STRING("std::stringstd::vectorstd::arraystd::string_view", result.c_str());
 }
 
+static void UNIT_TEST_3_blocking_write_with_chunk_sender()
+{
+    os_char_driver<64, 16> chardrv{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, chunk_send};
+
+    static constexpr size_t hw_fifo_size = 4;
+    std::string result;
+    unsigned num_tx_interrupts = 0;
+    helper_set_chunk_sender([&result, &num_tx_interrupts](const char *data, size_t len) {
+        auto accepted = std::min(len, hw_fifo_size);
+        result.append(data, accepted);
+        ++num_tx_interrupts;
+        return accepted;
+    });
+    helper_set_tx_isr_handler([&chardrv]() { chardrv.tx_isr_handler(); });
+    chardrv.write(std::string_view{"0123456789"}, std::string{"abc"});
+
+    TEST_ASSERT_EQUAL_STRING("0123456789abc", result.c_str());
+    TEST_ASSERT_EQUAL_UINT(4, num_tx_interrupts);
+}
+
+static void UNIT_TEST_4_buffered_write_returns_before_transmission()
+{
+    os_char_driver<64, 16, os_char_driver_buffered_tx<8>> chardrv{
+        tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send};
+
+    std::string result;
+    bool is_tx_stalled = true;
+    helper_set_byte_sender([&result](char c) { result += c; });
+    helper_set_tx_isr_handler([&chardrv, &is_tx_stalled]() {
+        if (is_tx_stalled)
+            tx_it_disable();
+        else
+            chardrv.tx_isr_handler();
+    });
+
+    TEST_ASSERT_EQUAL_UINT(5, chardrv.write(std::string_view{"01234"}));
+    TEST_ASSERT_EQUAL_STRING("", result.c_str());
+    TEST_ASSERT_FALSE(chardrv.flush(5));
+
+    is_tx_stalled = false;
+    tx_it_enable();
+    TEST_ASSERT_TRUE(chardrv.flush(os_no_timeout));
+    TEST_ASSERT_EQUAL_STRING("01234", result.c_str());
+
+    // Exceeds the buffer size, so the writer must wait for the ISR.
+    TEST_ASSERT_EQUAL_UINT(20, chardrv.write(std::string_view{"0123456789"}, std::string{"abcdefghij"}));
+    TEST_ASSERT_TRUE(chardrv.flush(os_no_timeout));
+    TEST_ASSERT_EQUAL_STRING("012340123456789abcdefghij", result.c_str());
+}
+
+static void UNIT_TEST_5_buffered_write_full_buffer_policies()
+{
+    os_char_driver<64, 16, os_char_driver_buffered_tx<8, os_char_driver_tx_full_policy::truncate>> truncating_chardrv{
+        tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send};
+    os_char_driver<64, 16, os_char_driver_buffered_tx<8, os_char_driver_tx_full_policy::fail>> failing_chardrv{
+        tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send};
+
+    // Nothing is transmitted, thus the buffers are never drained.
+    helper_set_tx_isr_handler([]() { tx_it_disable(); });
+
+    TEST_ASSERT_EQUAL_UINT(6, truncating_chardrv.write(std::string_view{"012345"}));
+    TEST_ASSERT_EQUAL_UINT(2, truncating_chardrv.write(std::string_view{"6789"}));
+
+    TEST_ASSERT_EQUAL_UINT(6, failing_chardrv.write(std::string_view{"012345"}));
+    TEST_ASSERT_EQUAL_UINT(0, failing_chardrv.write(std::string_view{"6"}, std::string_view{"789"}));
+    TEST_ASSERT_EQUAL_UINT(2, failing_chardrv.write(std::string_view{"67"}));
+}
+
+static void UNIT_TEST_6_readline_to_caller_buffer()
+{
+    // The buffer is small, so that the lines wrap around its end.
+    os_char_driver<32, 4> chardrv{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send, ">"};
+
+    std::array<char, 8> buf;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        for (char c : std::string_view{"\r\nOK\r\n>ERROR\r\nCONNECTED\r\n"})
+            chardrv.rx_isr_handler(c);
+
+        TEST_ASSERT_EQUAL_UINT(2, chardrv.readline(buf.data(), buf.size(), 0));
+        TEST_ASSERT_EQUAL_STRING_LEN("OK", buf.data(), 2);
+        TEST_ASSERT_EQUAL_UINT(1, chardrv.readline(buf.data(), buf.size(), 0));
+        TEST_ASSERT_EQUAL_STRING_LEN(">", buf.data(), 1);
+        TEST_ASSERT_EQUAL_UINT(5, chardrv.readline(buf.data(), buf.size(), 0));
+        TEST_ASSERT_EQUAL_STRING_LEN("ERROR", buf.data(), 5);
+        // Longer than the caller's buffer.
+        TEST_ASSERT_EQUAL_UINT(8, chardrv.readline(buf.data(), buf.size(), 0));
+        TEST_ASSERT_EQUAL_STRING_LEN("CONNECTE", buf.data(), 8);
+    }
+    TEST_ASSERT_EQUAL_UINT(0, chardrv.readline(buf.data(), buf.size(), 5));
+}
+
+static void UNIT_TEST_7_write_while_other_task_blocks_on_readline()
+{
+    os_char_driver<64, 16> chardrv{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send};
+
+    std::string line;
+    os_flag line_received;
+    os_task reader_task(
+        [&chardrv, &line, &line_received]() {
+            line = chardrv.readline(os_no_timeout);
+            line_received.set();
+        },
+        "reader",
+        256,
+        1);
+    os_delay_ms(10);
+
+    std::string result;
+    helper_set_byte_sender([&result](char c) { result += c; });
+    helper_set_tx_isr_handler([&chardrv]() { chardrv.tx_isr_handler(); });
+    chardrv.write(std::string_view{"AT+CSQ\r\n"});
+    TEST_ASSERT_EQUAL_STRING("AT+CSQ\r\n", result.c_str());
+
+    for (char c : std::string_view{"+CSQ: 20,99\r\n"})
+        chardrv.rx_isr_handler(c);
+    line_received.wait_set();
+    TEST_ASSERT_EQUAL_STRING("+CSQ: 20,99", line.c_str());
+}
+
+static void UNIT_TEST_8_burst_rx_matches_bytewise_rx()
+{
+    os_char_driver<48, 4> bytewise{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send, ">"};
+    os_char_driver<48, 4> burst{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send, ">"};
+
+    // Contains long lines, lines split between the bursts, skipped terminators, prompts and a line which does not fit.
+    std::string_view rx_data{"\r\n+CREG: 0,1\r\n\r\nOK\r\n>+CMGS: 12345\r\nA LINE WHICH IS LONGER THAN THE WHOLE RX "
+                             "BUFFER OF THE DRIVER\r\nERROR\r\n"};
+
+    for (unsigned i = 0; i < 2; ++i)
+    {
+        unsigned num_lines = 0;
+        for (size_t pos = 0, burst_len = 1; pos < rx_data.size(); pos += burst_len, burst_len = burst_len * 2 + 1)
+        {
+            auto part = rx_data.substr(pos, burst_len);
+            for (char c : part)
+                bytewise.rx_isr_handler(c);
+            burst.rx_isr_handler(part.data(), part.size());
+
+            std::string line;
+            for (; !(line = bytewise.readline(0)).empty(); ++num_lines)
+                TEST_ASSERT_EQUAL_STRING(line.c_str(), burst.readline(0).c_str());
+            TEST_ASSERT_EQUAL_STRING("", burst.readline(0).c_str());
+        }
+        // The line which does not fit is truncated and it leaves no room for "ERROR", which is dropped.
+        TEST_ASSERT_EQUAL_UINT(5, num_lines);
+    }
+
+    // All the lines completed by a single burst are available at once.
+    std::string_view four_lines{"OK\r\n>ERROR\r\nRING\r\n"};
+    burst.rx_isr_handler(four_lines.data(), four_lines.size());
+    for (auto expected : {"OK", ">", "ERROR", "RING"})
+        TEST_ASSERT_EQUAL_STRING(expected, burst.readline(0).c_str());
+}
+
+static void UNIT_TEST_9_slip_frames_loopback()
+{
+    using slip_driver = os_char_driver<64, 4, os_char_driver_unbuffered_tx, os_slip_framing>;
+    slip_driver chardrv{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send};
+
+    std::vector<char> encoded;
+    helper_set_byte_sender([&encoded](char c) { encoded.push_back(c); });
+    helper_set_tx_isr_handler([&chardrv]() { chardrv.tx_isr_handler(); });
+
+    std::string_view payload{"\x01\xC0\x02\xDB\xDB\xC0\r\n\0", 9};
+    TEST_ASSERT_TRUE(chardrv.write_frame(payload));
+    std::string_view expected_encoded{"\xC0\x01\xDB\xDC\x02\xDB\xDD\xDB\xDD\xDB\xDC\r\n\0\xC0", 15};
+    TEST_ASSERT_EQUAL_UINT(expected_encoded.size(), encoded.size());
+    TEST_ASSERT_EQUAL_MEMORY(expected_encoded.data(), encoded.data(), encoded.size());
+
+    std::array<char, 16> buf;
+    chardrv.rx_isr_handler(encoded.data(), encoded.size());
+    TEST_ASSERT_EQUAL_UINT(payload.size(), chardrv.read_frame(buf.data(), buf.size(), 0));
+    TEST_ASSERT_EQUAL_MEMORY(payload.data(), buf.data(), payload.size());
+
+    // An invalid escape sequence and a frame longer than the RX buffer are dropped.
+    std::string_view malformed{"AB\xDB\x01" "CD\xC0", 7};
+    for (char c : malformed)
+        chardrv.rx_isr_handler(c);
+    std::string too_long(65, 'x');
+    TEST_ASSERT_TRUE(chardrv.write_frame(too_long));
+    for (char c : encoded)
+        chardrv.rx_isr_handler(c);
+    TEST_ASSERT_EQUAL_UINT(payload.size(), chardrv.read_frame(buf.data(), buf.size(), 0));
+    TEST_ASSERT_EQUAL_MEMORY(payload.data(), buf.data(), payload.size());
+    TEST_ASSERT_EQUAL_UINT(0, chardrv.read_frame(buf.data(), buf.size(), 0));
+}
+
+static void UNIT_TEST_10_cobs_frames_loopback()
+{
+    using cobs_driver = os_char_driver<1024, 8, os_char_driver_unbuffered_tx, os_cobs_framing>;
+    cobs_driver chardrv{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, chunk_send};
+
+    helper_set_chunk_sender([&chardrv](const char *data, size_t len) {
+        chardrv.rx_isr_handler(data, len);
+        return len;
+    });
+    helper_set_tx_isr_handler([&chardrv]() { chardrv.tx_isr_handler(); });
+
+    auto make_payload = [](size_t len, size_t zero_every) {
+        std::vector<char> payload(len);
+        for (size_t i = 0; i < len; ++i)
+            payload[i] = zero_every && (i % zero_every == 0) ? '\0' : static_cast<char>(i % 255 + 1);
+        return payload;
+    };
+
+    // Including the blocks of the maximum length, the payloads which begin and end with zeros and the zeros only.
+    std::vector<std::vector<char>> payloads{make_payload(1, 1),   make_payload(5, 0),   make_payload(254, 0),
+                                            make_payload(255, 0), make_payload(600, 0), make_payload(300, 7),
+                                            make_payload(6, 1),   make_payload(509, 255)};
+    std::vector<char> buf(1024);
+    for (auto &payload : payloads)
+    {
+        TEST_ASSERT_TRUE(chardrv.write_frame(payload));
+        TEST_ASSERT_EQUAL_UINT(payload.size(), chardrv.read_frame(buf.data(), buf.size(), 0));
+        TEST_ASSERT_EQUAL_MEMORY(payload.data(), buf.data(), payload.size());
+    }
+
+    // A frame cut by the delimiter is dropped.
+    std::string_view malformed{"\x05" "ab\0\x03" "xy\0", 8};
+    chardrv.rx_isr_handler(malformed.data(), malformed.size());
+    TEST_ASSERT_EQUAL_UINT(2, chardrv.read_frame(buf.data(), buf.size(), 0));
+    TEST_ASSERT_EQUAL_STRING_LEN("xy", buf.data(), 2);
+    TEST_ASSERT_EQUAL_UINT(0, chardrv.read_frame(buf.data(), buf.size(), 0));
+}
+
+static void UNIT_TEST_11_rx_loss_accounting_and_flow_control()
+{
+    os_char_driver<16, 2> chardrv{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send};
+    chardrv.enable_rx_flow_control(rx_stop, rx_resume, 12, 4);
+    is_rx_stopped = false;
+
+    auto receive = [&chardrv](std::string_view data) {
+        for (char c : data)
+            chardrv.rx_isr_handler(c);
+    };
+
+    receive("0123456789\r\n");
+    TEST_ASSERT_FALSE(is_rx_stopped);
+    receive("AB");
+    TEST_ASSERT_TRUE(is_rx_stopped);
+
+    // The peer ignores the flow control, so the bytes which do not fit are dropped.
+    receive("CDEFGHIJ\r\n");
+    receive("XY\r\n");
+    chardrv.rx_overrun_isr_handler();
+    auto stats = chardrv.rx_stats();
+    TEST_ASSERT_EQUAL_UINT(6, stats.num_dropped_bytes);
+    TEST_ASSERT_EQUAL_UINT(1, stats.num_dropped_lines);
+    TEST_ASSERT_EQUAL_UINT(1, stats.num_overruns);
+
+    TEST_ASSERT_EQUAL_STRING("0123456789", chardrv.readline(0).c_str());
+    TEST_ASSERT_TRUE(is_rx_stopped);
+    TEST_ASSERT_EQUAL_STRING("ABCDEF", chardrv.readline(0).c_str());
+    TEST_ASSERT_FALSE(is_rx_stopped);
+}
+
+static void UNIT_TEST_12_buffered_write_stops_at_truncated_string()
+{
+    os_char_driver<64, 16, os_char_driver_buffered_tx<8, os_char_driver_tx_full_policy::truncate>> chardrv{
+        tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, byte_send};
+
+    std::string result;
+    helper_set_byte_sender([&result](char c) { result += c; });
+    // The ISR empties the buffer right after the first string has filled it, so the transmission is stalled only
+    // while the first string is truncated and there is room for the second string.
+    helper_set_tx_isr_handler([&chardrv]() { chardrv.tx_isr_handler(); });
+
+    TEST_ASSERT_EQUAL_UINT(8, chardrv.write(std::string_view{"0123456789"}, std::string_view{"ab"}));
+    TEST_ASSERT_TRUE(chardrv.flush(os_no_timeout));
+    TEST_ASSERT_EQUAL_STRING("01234567", result.c_str());
+}
+
+static void UNIT_TEST_13_buffered_write_does_not_overwrite_chunk_in_flight()
+{
+    os_char_driver<64, 16, os_char_driver_buffered_tx<8, os_char_driver_tx_full_policy::truncate>> chardrv{
+        tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, chunk_send};
+
+    // The chunk sender starts a DMA transfer, which reads the TX buffer until the transfer complete ISR.
+    const char *dma_src = nullptr;
+    size_t dma_len = 0;
+    bool is_dma_busy = false;
+    helper_set_chunk_sender([&dma_src, &dma_len, &is_dma_busy](const char *data, size_t len) {
+        dma_src = data;
+        dma_len = len;
+        is_dma_busy = true;
+        return len;
+    });
+    helper_set_tx_isr_handler([&chardrv, &is_dma_busy]() {
+        if (is_dma_busy)
+            tx_it_disable();
+        else
+            chardrv.tx_isr_handler();
+    });
+
+    TEST_ASSERT_EQUAL_UINT(8, chardrv.write(std::string_view{"01234567"}));
+    TEST_ASSERT_EQUAL_UINT(0, chardrv.write(std::string_view{"abcd"}));
+    TEST_ASSERT_EQUAL_STRING("01234567", std::string(dma_src, dma_len).c_str());
+
+    is_dma_busy = false;
+    tx_it_enable();
+    TEST_ASSERT_TRUE(chardrv.flush(os_no_timeout));
+    TEST_ASSERT_EQUAL_UINT(4, chardrv.write(std::string_view{"abcd"}));
+    TEST_ASSERT_EQUAL_STRING("abcd", std::string(dma_src, dma_len).c_str());
+}
+
+static void UNIT_TEST_14_unbuffered_frame_parts_are_written_in_chunks()
+{
+    using slip_driver = os_char_driver<64, 4, os_char_driver_unbuffered_tx, os_slip_framing>;
+    slip_driver chardrv{tx_it_enable, tx_it_disable, rx_it_enable, rx_it_disable, chunk_send};
+
+    std::string encoded;
+    unsigned num_writes = 0;
+    helper_set_chunk_sender([&encoded, &num_writes](const char *data, size_t len) {
+        encoded.append(data, len);
+        ++num_writes;
+        return len;
+    });
+    helper_set_tx_isr_handler([&chardrv]() { chardrv.tx_isr_handler(); });
+
+    // All the escapes and the bytes between them fit into a single write.
+    TEST_ASSERT_TRUE(chardrv.write_frame(std::string_view{"\x01\xC0\x02\xDB\xDB\xC0\r\n", 8}));
+    TEST_ASSERT_EQUAL_UINT(1, num_writes);
+    TEST_ASSERT_EQUAL_STRING("\xC0\x01\xDB\xDC\x02\xDB\xDD\xDB\xDD\xDB\xDC\r\n\xC0", encoded.c_str());
+
+    // A long run of the payload is written on its own, between the gathered escapes.
+    encoded.clear();
+    num_writes = 0;
+    std::string run(40, 'a');
+    TEST_ASSERT_TRUE(chardrv.write_frame("\xC0" + run + "\xDB"));
+    TEST_ASSERT_EQUAL_UINT(3, num_writes);
+    TEST_ASSERT_EQUAL_STRING(("\xC0\xDB\xDC" + run + "\xDB\xDD\xC0").c_str(), encoded.c_str());
+}
+
 // --------------------------------------------------------------------------------------------------------------------
 // DEFINITION OF PRIVATE FUNCTIONS
 // --------------------------------------------------------------------------------------------------------------------
@@ -127,6 +493,11 @@ static void helper_set_rx_isr_handler(std::function<void(void)> f)
     rx_isr_handler = f;
 }
 
+static void helper_set_chunk_sender(std::function<size_t(const char *, size_t)> f)
+{
+    chunk_sender = f;
+}
+
 static void tx_isr_handler_callback(int signal)
 {
     tx_isr_handler();
@@ -163,7 +534,22 @@ static void rx_it_disable()
 {
 }
 
+static void rx_stop()
+{
+    is_rx_stopped = true;
+}
+
+static void rx_resume()
+{
+    is_rx_stopped = false;
+}
+
 static void byte_send(char c)
 {
     byte_sender(c);
 }
+
+static size_t chunk_send(const char *data, size_t len)
+{
+    return chunk_sender(data, len);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file	test_os_char_mux.cpp
+ * @brief	Tests os_char_mux template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_char_mux.hpp"
+#include "os_queue.hpp"
+#include "unity.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_lines_are_routed_to_handlers_and_queues_of_their_ports();
+static void UNIT_TEST_2_full_queue_is_accounted_in_port_stats();
+static void UNIT_TEST_3_busy_port_does_not_starve_the_others();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+using test_char_driver = os_char_driver<64, 4>;
+using test_char_mux = os_char_mux<3, test_char_driver, 16>;
+
+static void it_enable_disable();
+static void byte_send(char c);
+static test_char_driver &helper_open(test_char_mux &mux, size_t port, test_char_mux::line_handler handler);
+static void helper_receive(test_char_driver &drv, std::string_view data);
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_char_mux()
+{
+    RUN_TEST(UNIT_TEST_1_lines_are_routed_to_handlers_and_queues_of_their_ports);
+    RUN_TEST(UNIT_TEST_2_full_queue_is_accounted_in_port_stats);
+    RUN_TEST(UNIT_TEST_3_busy_port_does_not_starve_the_others);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_lines_are_routed_to_handlers_and_queues_of_their_ports()
+{
+    test_char_mux mux;
+    std::vector<std::string> lines0;
+    os_queue<std::string, 4> queue2;
+    helper_open(mux, 0, [&lines0](std::string_view line) { lines0.emplace_back(line); });
+    mux.open_queued(2, queue2, it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send);
+
+    helper_receive(mux.driver(2), "+CMTI: \"SM\",3\r\n");
+    helper_receive(mux.driver(0), "OK\r\n");
+    while (mux.serve(0))
+        ;
+
+    TEST_ASSERT_EQUAL_UINT(1, lines0.size());
+    TEST_ASSERT_EQUAL_STRING("OK", lines0[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("+CMTI: \"SM\",3", queue2.receive(0).leftValue.c_str());
+
+    auto stats2 = mux.stats(2);
+    TEST_ASSERT_EQUAL_UINT(1, stats2.num_lines);
+    TEST_ASSERT_EQUAL_UINT(13, stats2.num_bytes);
+    TEST_ASSERT_EQUAL_UINT(0, mux.stats(1).num_lines);
+}
+
+static void UNIT_TEST_2_full_queue_is_accounted_in_port_stats()
+{
+    test_char_mux mux;
+    os_queue<std::string, 2> queue;
+    auto &drv = mux.open_queued(
+        1, queue, it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send);
+
+    helper_receive(drv, "1\r\n2\r\n3\r\n");
+    while (mux.serve(0))
+        ;
+
+    auto stats = mux.stats(1);
+    TEST_ASSERT_EQUAL_UINT(3, stats.num_lines);
+    TEST_ASSERT_EQUAL_UINT(1, stats.num_unrouted_lines);
+    TEST_ASSERT_EQUAL_STRING("1", queue.receive(0).leftValue.c_str());
+    TEST_ASSERT_EQUAL_STRING("2", queue.receive(0).leftValue.c_str());
+}
+
+static void UNIT_TEST_3_busy_port_does_not_starve_the_others()
+{
+    test_char_mux mux;
+    std::string served_ports;
+    for (size_t port = 0; port < 3; ++port)
+        helper_open(mux, port, [&served_ports, port](std::string_view) { served_ports += '0' + port; });
+
+    helper_receive(mux.driver(0), "a\r\nb\r\nc\r\nd\r\n");
+    helper_receive(mux.driver(1), "e\r\n");
+    helper_receive(mux.driver(2), "f\r\ng\r\n");
+    while (mux.serve(0))
+        ;
+
+    TEST_ASSERT_EQUAL_STRING("0120200", served_ports.c_str());
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PRIVATE FUNCTIONS
+// --------------------------------------------------------------------------------------------------------------------
+static void it_enable_disable()
+{
+}
+
+static void byte_send(char c)
+{
+}
+
+static test_char_driver &helper_open(test_char_mux &mux, size_t port, test_char_mux::line_handler handler)
+{
+    return mux.open(
+        port, handler, it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send);
+}
+
+static void helper_receive(test_char_driver &drv, std::string_view data)
+{
+    drv.rx_isr_handler(data.data(), data.size());
+}
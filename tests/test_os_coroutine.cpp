@@ -0,0 +1,216 @@
+/**
+ * @file	test_os_coroutine.cpp
+ * @brief	Tests os_coroutine_scheduler template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_char_driver.hpp"
+#include "os_coroutine.hpp"
+#include "os_flag.hpp"
+#include "os_queue.hpp"
+#include "unity.h"
+#include <atomic>
+#include <string>
+#include <string_view>
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_coroutines_are_resumed_when_their_queues_receive();
+static void UNIT_TEST_2_coroutine_awaits_flag_delay_and_timeout();
+static void UNIT_TEST_3_coroutine_reads_line_from_char_driver();
+static void UNIT_TEST_4_spawn_fails_when_there_is_no_frame_left();
+static void UNIT_TEST_5_line_taken_by_another_reader_does_not_end_readline();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+using test_scheduler = os_coroutine_scheduler<4, 512>;
+using test_char_driver = os_char_driver<64, 4>;
+
+//! Is always ready, but the first line is taken by another reader before the coroutine reads it.
+struct racing_char_driver
+{
+    bool is_ready()
+    {
+        return true;
+    }
+
+    void attach_listener(os_wait_set_listener *)
+    {
+    }
+
+    size_t readline(char *buf, size_t buf_size, unsigned timeout_ms)
+    {
+        if (num_reads++ == 0)
+            return 0;
+        buf[0] = 'x';
+        return 1;
+    }
+
+    unsigned num_reads{0};
+};
+
+//! Outlive the schedulers, whose tasks may still be in set() when the test case returns.
+static os_flag coroutines_done;
+static os_flag start;
+static os_flag never_set;
+
+static os_coroutine sum_elements(test_scheduler &sched, os_queue<int, 4> &queue, int &sum, std::atomic<int> &num_done);
+static os_coroutine measure_delay(test_scheduler &sched,
+                                  os_tick_type_t &delay,
+                                  bool &is_timed_out,
+                                  os_queue<int, 4> &empty_queue);
+template <typename CharDriver>
+static os_coroutine read_line(test_scheduler &sched, CharDriver &driver, std::string &line);
+template <typename Scheduler> static os_coroutine wait_forever(Scheduler &sched);
+
+static void it_enable_disable();
+static void byte_send(char c);
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_coroutine()
+{
+    RUN_TEST(UNIT_TEST_1_coroutines_are_resumed_when_their_queues_receive);
+    RUN_TEST(UNIT_TEST_2_coroutine_awaits_flag_delay_and_timeout);
+    RUN_TEST(UNIT_TEST_3_coroutine_reads_line_from_char_driver);
+    RUN_TEST(UNIT_TEST_4_spawn_fails_when_there_is_no_frame_left);
+    RUN_TEST(UNIT_TEST_5_line_taken_by_another_reader_does_not_end_readline);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_coroutines_are_resumed_when_their_queues_receive()
+{
+    coroutines_done.reset();
+    os_queue<int, 4> queues[3];
+    int sums[3] = {0, 0, 0};
+    std::atomic<int> num_done{0};
+    test_scheduler sched("coroutines", 512, 1);
+
+    for (int i = 0; i < 3; ++i)
+        TEST_ASSERT_TRUE(sched.spawn(sum_elements(sched, queues[i], sums[i], num_done)));
+    for (int i = 1; i <= 2; ++i)
+        for (int q = 2; q >= 0; --q)
+        {
+            queues[q].send(i * (q + 1));
+            os_delay_ms(1);
+        }
+
+    coroutines_done.wait_set();
+    TEST_ASSERT_EQUAL_INT(3, sums[0]);
+    TEST_ASSERT_EQUAL_INT(6, sums[1]);
+    TEST_ASSERT_EQUAL_INT(9, sums[2]);
+}
+
+static void UNIT_TEST_2_coroutine_awaits_flag_delay_and_timeout()
+{
+    coroutines_done.reset();
+    start.reset();
+    os_tick_type_t delay = 0;
+    bool is_timed_out = false;
+    os_queue<int, 4> empty_queue;
+    test_scheduler sched("coroutines", 512, 1);
+
+    TEST_ASSERT_TRUE(sched.spawn(measure_delay(sched, delay, is_timed_out, empty_queue)));
+    os_delay_ms(5);
+    TEST_ASSERT_FALSE(coroutines_done.is_set());
+    start.set();
+
+    coroutines_done.wait_set();
+    TEST_ASSERT_TRUE(delay >= os_timeout_to_ticks(20));
+    TEST_ASSERT_TRUE(is_timed_out);
+}
+
+static void UNIT_TEST_3_coroutine_reads_line_from_char_driver()
+{
+    coroutines_done.reset();
+    test_char_driver driver(it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send);
+    std::string line;
+    test_scheduler sched("coroutines", 512, 1);
+
+    TEST_ASSERT_TRUE(sched.spawn(read_line(sched, driver, line)));
+    os_delay_ms(5);
+    std::string_view data{"hello\r\n"};
+    driver.rx_isr_handler(data.data(), data.size());
+
+    coroutines_done.wait_set();
+    TEST_ASSERT_EQUAL_STRING("hello", line.c_str());
+}
+
+static void UNIT_TEST_4_spawn_fails_when_there_is_no_frame_left()
+{
+    never_set.reset();
+    os_coroutine_scheduler<2, 512> sched("coroutines", 512, 1);
+    TEST_ASSERT_TRUE(sched.spawn(wait_forever(sched)));
+    TEST_ASSERT_TRUE(sched.spawn(wait_forever(sched)));
+    TEST_ASSERT_FALSE(sched.spawn(wait_forever(sched)));
+
+    os_coroutine_scheduler<2, 8> too_small_frames("coroutines", 512, 1);
+    TEST_ASSERT_FALSE(too_small_frames.spawn(wait_forever(too_small_frames)));
+    // The coroutines which wait forever are destroyed along with the scheduler.
+}
+
+static void UNIT_TEST_5_line_taken_by_another_reader_does_not_end_readline()
+{
+    coroutines_done.reset();
+    racing_char_driver driver;
+    std::string line;
+    test_scheduler sched("coroutines", 512, 1);
+
+    TEST_ASSERT_TRUE(sched.spawn(read_line(sched, driver, line)));
+
+    coroutines_done.wait_set();
+    TEST_ASSERT_EQUAL_STRING("x", line.c_str());
+    TEST_ASSERT_EQUAL_UINT(2, driver.num_reads);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PRIVATE FUNCTIONS
+// --------------------------------------------------------------------------------------------------------------------
+static os_coroutine sum_elements(test_scheduler &sched, os_queue<int, 4> &queue, int &sum, std::atomic<int> &num_done)
+{
+    for (int i = 0; i < 2; ++i)
+        sum += (co_await sched.receive(queue)).leftValue;
+    if (num_done.fetch_add(1) + 1 == 3)
+        coroutines_done.set();
+}
+
+static os_coroutine measure_delay(test_scheduler &sched,
+                                  os_tick_type_t &delay,
+                                  bool &is_timed_out,
+                                  os_queue<int, 4> &empty_queue)
+{
+    co_await sched.wait_set(start);
+    auto begin = os_get_tick_count();
+    co_await sched.delay(20);
+    delay = os_get_tick_count() - begin;
+    is_timed_out = !(co_await sched.receive(empty_queue, 10)).isLeft;
+    coroutines_done.set();
+}
+
+template <typename CharDriver>
+static os_coroutine read_line(test_scheduler &sched, CharDriver &driver, std::string &line)
+{
+    char buf[16];
+    auto len = co_await sched.readline(driver, buf, sizeof(buf));
+    line.assign(buf, len);
+    coroutines_done.set();
+}
+
+template <typename Scheduler> static os_coroutine wait_forever(Scheduler &sched)
+{
+    co_await sched.wait_set(never_set);
+}
+
+static void it_enable_disable()
+{
+}
+
+static void byte_send(char c)
+{
+}
@@ -0,0 +1,140 @@
+/**
+ * @file	test_os_executor.cpp
+ * @brief	Tests os_executor template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_executor.hpp"
+#include "os_flag.hpp"
+#include "unity.h"
+#include <atomic>
+#include <string>
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_all_submitted_jobs_are_run_by_the_workers();
+static void UNIT_TEST_2_urgent_jobs_are_run_first();
+static void UNIT_TEST_3_submit_fails_when_the_queue_is_full();
+static void UNIT_TEST_4_idle_worker_steals_jobs_from_the_local_queue_of_a_busy_one();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+//! The flags outlive the jobs, which may still be in set() when the test case returns.
+static os_flag job_started, gate, jobs_done;
+
+static void reset_flags();
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_executor()
+{
+    RUN_TEST(UNIT_TEST_1_all_submitted_jobs_are_run_by_the_workers);
+    RUN_TEST(UNIT_TEST_2_urgent_jobs_are_run_first);
+    RUN_TEST(UNIT_TEST_3_submit_fails_when_the_queue_is_full);
+    RUN_TEST(UNIT_TEST_4_idle_worker_steals_jobs_from_the_local_queue_of_a_busy_one);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_all_submitted_jobs_are_run_by_the_workers()
+{
+    reset_flags();
+    os_executor<3, 16> executor{"worker", 256, 1};
+    std::atomic<unsigned> num_jobs_run{0};
+    constexpr unsigned num_jobs = 16;
+
+    for (unsigned i = 0; i < num_jobs; ++i)
+        TEST_ASSERT_TRUE(executor.submit([&num_jobs_run]() {
+            if (num_jobs_run.fetch_add(1) + 1 == num_jobs)
+                jobs_done.set();
+        }));
+
+    jobs_done.wait_set();
+    TEST_ASSERT_EQUAL_UINT(num_jobs, num_jobs_run.load());
+}
+
+static void UNIT_TEST_2_urgent_jobs_are_run_first()
+{
+    reset_flags();
+    os_executor<1, 4> executor{"worker", 256, 1};
+    std::string order;
+
+    executor.submit([]() {
+        job_started.set();
+        gate.wait_set();
+    });
+    job_started.wait_set();
+
+    executor.submit([&order]() { order += 'A'; });
+    executor.submit([&order]() { order += 'B'; });
+    executor.submit_urgent([&order]() { order += 'U'; });
+    executor.submit([&order]() {
+        order += 'C';
+        jobs_done.set();
+    });
+    gate.set();
+
+    jobs_done.wait_set();
+    TEST_ASSERT_EQUAL_STRING("UABC", order.c_str());
+}
+
+static void UNIT_TEST_3_submit_fails_when_the_queue_is_full()
+{
+    reset_flags();
+    os_executor<1, 2> executor{"worker", 256, 1};
+
+    executor.submit([]() {
+        job_started.set();
+        gate.wait_set();
+    });
+    job_started.wait_set();
+
+    TEST_ASSERT_TRUE(executor.submit([]() {}));
+    TEST_ASSERT_TRUE(executor.submit([]() {}));
+    TEST_ASSERT_FALSE(executor.submit([]() {}));
+    TEST_ASSERT_TRUE(executor.submit_urgent([]() {}));
+    gate.set();
+}
+
+static void UNIT_TEST_4_idle_worker_steals_jobs_from_the_local_queue_of_a_busy_one()
+{
+    reset_flags();
+    os_executor<2, 2, 4> executor{"worker", 256, 1};
+    std::atomic<unsigned> num_children_run{0}, num_children_rejected{0};
+    constexpr unsigned num_children = 4;
+
+    // The children go to the local queue of the worker which runs the parent; the shared queue is too small for them.
+    // The parent keeps its worker busy until all the children are run, so they can only be run by the other worker.
+    executor.submit([&executor, &num_children_run, &num_children_rejected]() {
+        for (unsigned i = 0; i < num_children; ++i)
+        {
+            bool is_submitted = executor.submit([&num_children_run]() {
+                if (num_children_run.fetch_add(1) + 1 == num_children)
+                    jobs_done.set();
+            });
+            if (!is_submitted)
+                num_children_rejected.fetch_add(1);
+        }
+        gate.wait_set();
+    });
+
+    jobs_done.wait_set();
+    TEST_ASSERT_EQUAL_UINT(num_children, num_children_run.load());
+    TEST_ASSERT_EQUAL_UINT(0, num_children_rejected.load());
+    gate.set();
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PRIVATE FUNCTIONS
+// --------------------------------------------------------------------------------------------------------------------
+static void reset_flags()
+{
+    job_started.reset();
+    gate.reset();
+    jobs_done.reset();
+}
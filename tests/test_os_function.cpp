@@ -0,0 +1,130 @@
+/**
+ * @file	test_os_function.cpp
+ * @brief	Tests os_function template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_function.hpp"
+#include "unity.h"
+#include <string>
+#include <utility>
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_calls_the_stored_lambda_and_the_function();
+static void UNIT_TEST_2_copies_and_moves_the_functional_object();
+static void UNIT_TEST_3_functional_object_is_destroyed_once();
+static void UNIT_TEST_4_empty_function_converts_to_false();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+//! Counts the living instances of itself.
+struct instance_counter
+{
+    static inline int num_instances{0};
+
+    instance_counter()
+    {
+        ++num_instances;
+    }
+
+    instance_counter(const instance_counter &)
+    {
+        ++num_instances;
+    }
+
+    ~instance_counter()
+    {
+        --num_instances;
+    }
+
+    void operator()() const
+    {
+    }
+};
+
+static int add(int a, int b);
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_function()
+{
+    RUN_TEST(UNIT_TEST_1_calls_the_stored_lambda_and_the_function);
+    RUN_TEST(UNIT_TEST_2_copies_and_moves_the_functional_object);
+    RUN_TEST(UNIT_TEST_3_functional_object_is_destroyed_once);
+    RUN_TEST(UNIT_TEST_4_empty_function_converts_to_false);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_calls_the_stored_lambda_and_the_function()
+{
+    int a = 1, b = 2, c = 3, d = 4;
+    os_function<int(int)> f{[&a, &b, &c, &d](int x) { return x * (a + b + c + d); }};
+    TEST_ASSERT_EQUAL_INT(20, f(2));
+
+    // A bigger functional object needs a bigger Capacity, otherwise it doesn't compile.
+    std::string s{"captured by value"};
+    os_function<size_t(void), sizeof(std::string)> g{[s]() { return s.size(); }};
+    TEST_ASSERT_EQUAL_UINT(17, g());
+
+    os_function<int(int, int)> h{add};
+    TEST_ASSERT_EQUAL_INT(5, h(2, 3));
+}
+
+static void UNIT_TEST_2_copies_and_moves_the_functional_object()
+{
+    int calls = 0;
+    os_function<void(void)> f{[&calls]() { ++calls; }};
+
+    auto copy = f;
+    auto moved = std::move(f);
+    os_function<void(void)> assigned;
+    assigned = copy;
+    copy();
+    moved();
+    assigned();
+
+    TEST_ASSERT_EQUAL_INT(3, calls);
+}
+
+static void UNIT_TEST_3_functional_object_is_destroyed_once()
+{
+    {
+        os_function<void(void)> f{instance_counter{}};
+        TEST_ASSERT_EQUAL_INT(1, instance_counter::num_instances);
+        auto copy = f;
+        TEST_ASSERT_EQUAL_INT(2, instance_counter::num_instances);
+        copy = nullptr;
+        TEST_ASSERT_EQUAL_INT(1, instance_counter::num_instances);
+        copy = f;
+        f = std::move(copy);
+        TEST_ASSERT_EQUAL_INT(2, instance_counter::num_instances);
+    }
+    TEST_ASSERT_EQUAL_INT(0, instance_counter::num_instances);
+}
+
+static void UNIT_TEST_4_empty_function_converts_to_false()
+{
+    os_function<void(void)> f;
+    TEST_ASSERT_FALSE(f);
+
+    f = []() {};
+    TEST_ASSERT_TRUE(f);
+
+    f = nullptr;
+    TEST_ASSERT_FALSE(f);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PRIVATE FUNCTIONS
+// --------------------------------------------------------------------------------------------------------------------
+static int add(int a, int b)
+{
+    return a + b;
+}
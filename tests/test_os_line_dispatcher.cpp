@@ -0,0 +1,244 @@
+/**
+ * @file	test_os_line_dispatcher.cpp
+ * @brief	Tests os_line_dispatcher template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_char_driver.hpp"
+#include "os_flag.hpp"
+#include "os_line_dispatcher.hpp"
+#include "os_task.hpp"
+#include "unity.h"
+#include <string>
+#include <string_view>
+#include <vector>
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_dispatch_times_out_when_no_line_is_received();
+static void UNIT_TEST_2_lines_are_passed_to_the_handlers_of_their_ports();
+static void UNIT_TEST_3_dispatch_blocks_until_any_port_receives_a_line();
+static void UNIT_TEST_4_line_taken_by_another_reader_does_not_end_dispatch();
+static void UNIT_TEST_5_dispatch_blocks_while_another_reader_holds_the_line();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+using test_char_driver = os_char_driver<64, 4>;
+
+//! Is always ready, but the first line is taken by another reader before the dispatcher reads it.
+struct racing_char_driver
+{
+    bool is_ready()
+    {
+        return true;
+    }
+
+    void attach_listener(os_wait_set_listener *)
+    {
+    }
+
+    size_t readline(char *buf, size_t buf_size, unsigned timeout_ms)
+    {
+        if (num_reads++ == 0)
+            return 0;
+        buf[0] = 'x';
+        return 1;
+    }
+
+    unsigned num_reads{0};
+};
+
+//! Counts the reads of the dispatcher, so that it can be told whether it blocks or spins.
+struct counting_char_driver
+{
+    bool is_ready()
+    {
+        return driver.is_ready();
+    }
+
+    void attach_listener(os_wait_set_listener *listener)
+    {
+        driver.attach_listener(listener);
+    }
+
+    size_t readline(char *buf, size_t buf_size, unsigned timeout_ms)
+    {
+        ++num_reads;
+        return driver.readline(buf, buf_size, timeout_ms);
+    }
+
+    test_char_driver &driver;
+    unsigned num_reads{0};
+};
+
+//! Outlive the tasks, which may still be in set() when the test case returns.
+static os_flag rx_resumer_entered;
+static os_flag rx_resumer_released;
+static os_flag first_read;
+static os_flag second_read;
+
+static void it_enable_disable();
+static void rx_stop();
+static void rx_resume();
+static void byte_send(char c);
+static void helper_receive(test_char_driver &drv, std::string_view data);
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_line_dispatcher()
+{
+    RUN_TEST(UNIT_TEST_1_dispatch_times_out_when_no_line_is_received);
+    RUN_TEST(UNIT_TEST_2_lines_are_passed_to_the_handlers_of_their_ports);
+    RUN_TEST(UNIT_TEST_3_dispatch_blocks_until_any_port_receives_a_line);
+    RUN_TEST(UNIT_TEST_4_line_taken_by_another_reader_does_not_end_dispatch);
+    RUN_TEST(UNIT_TEST_5_dispatch_blocks_while_another_reader_holds_the_line);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_dispatch_times_out_when_no_line_is_received()
+{
+    test_char_driver drv{it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send};
+    os_line_dispatcher<1, 16> dispatcher;
+    dispatcher.add(drv, [](std::string_view) { TEST_FAIL(); });
+
+    helper_receive(drv, "incomplete");
+    TEST_ASSERT_FALSE(dispatcher.dispatch(5));
+}
+
+static void UNIT_TEST_2_lines_are_passed_to_the_handlers_of_their_ports()
+{
+    test_char_driver drv1{it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send};
+    test_char_driver drv2{it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send};
+    std::vector<std::string> lines1, lines2;
+    os_line_dispatcher<2, 8> dispatcher;
+    dispatcher.add(drv1, [&lines1](std::string_view line) { lines1.emplace_back(line); });
+    dispatcher.add(drv2, [&lines2](std::string_view line) { lines2.emplace_back(line); });
+
+    helper_receive(drv1, "A1\r\nA2\r\nA3\r\n");
+    helper_receive(drv2, "B1 LONGER THAN THE LINE BUFFER\r\n");
+    while (dispatcher.dispatch(0))
+        ;
+
+    TEST_ASSERT_EQUAL_UINT(3, lines1.size());
+    TEST_ASSERT_EQUAL_STRING("A1", lines1[0].c_str());
+    TEST_ASSERT_EQUAL_STRING("A3", lines1[2].c_str());
+    TEST_ASSERT_EQUAL_UINT(1, lines2.size());
+    TEST_ASSERT_EQUAL_STRING("B1 LONGE", lines2[0].c_str());
+}
+
+static void UNIT_TEST_3_dispatch_blocks_until_any_port_receives_a_line()
+{
+    test_char_driver drv1{it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send};
+    test_char_driver drv2{it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send};
+    std::string line2;
+    os_line_dispatcher<2, 16> dispatcher;
+    dispatcher.add(drv1, [](std::string_view) { TEST_FAIL(); });
+    dispatcher.add(drv2, [&line2](std::string_view line) { line2 = line; });
+
+    os_task isr_task(
+        [&drv2]() {
+            os_delay_ms(10);
+            helper_receive(drv2, "RING\r\n");
+        },
+        "isr",
+        256,
+        1);
+
+    TEST_ASSERT_TRUE(dispatcher.dispatch(os_no_timeout));
+    TEST_ASSERT_EQUAL_STRING("RING", line2.c_str());
+}
+
+static void UNIT_TEST_4_line_taken_by_another_reader_does_not_end_dispatch()
+{
+    racing_char_driver drv;
+    std::string line;
+    os_line_dispatcher<1, 8> dispatcher;
+    dispatcher.add(drv, [&line](std::string_view l) { line = l; });
+
+    TEST_ASSERT_TRUE(dispatcher.dispatch(5));
+    TEST_ASSERT_EQUAL_STRING("x", line.c_str());
+    TEST_ASSERT_EQUAL_UINT(2, drv.num_reads);
+}
+
+static void UNIT_TEST_5_dispatch_blocks_while_another_reader_holds_the_line()
+{
+    rx_resumer_entered.reset();
+    rx_resumer_released.reset();
+    first_read.reset();
+    second_read.reset();
+    test_char_driver drv{it_enable_disable, it_enable_disable, it_enable_disable, it_enable_disable, byte_send};
+    drv.enable_rx_flow_control(rx_stop, rx_resume, 4, 3);
+    counting_char_driver counting_drv{drv};
+    std::string line;
+    os_line_dispatcher<1, 16> dispatcher;
+    dispatcher.add(counting_drv, [&line](std::string_view l) { line = l; });
+
+    helper_receive(drv, "FIRST\r\nB\r\n");
+
+    // The first reader pops its line and then stays in the RX resumer with the RX lock held. The second reader takes
+    // the semaphore of the other line and waits for the lock, thus it holds the line without popping it.
+    std::string first, second;
+    os_task first_reader(
+        [&drv, &first]() {
+            first = drv.readline(os_no_timeout);
+            first_read.set();
+        },
+        "first_reader",
+        256,
+        1);
+    rx_resumer_entered.wait_set();
+    os_task second_reader(
+        [&drv, &second]() {
+            second = drv.readline(os_no_timeout);
+            second_read.set();
+        },
+        "second_reader",
+        256,
+        1);
+    os_delay_ms(5);
+
+    TEST_ASSERT_FALSE(dispatcher.dispatch(20));
+    TEST_ASSERT_EQUAL_UINT(0, counting_drv.num_reads);
+
+    rx_resumer_released.set();
+    first_read.wait_set();
+    second_read.wait_set();
+    TEST_ASSERT_EQUAL_STRING("FIRST", first.c_str());
+    TEST_ASSERT_EQUAL_STRING("B", second.c_str());
+
+    helper_receive(drv, "C\r\n");
+    TEST_ASSERT_TRUE(dispatcher.dispatch(os_no_timeout));
+    TEST_ASSERT_EQUAL_STRING("C", line.c_str());
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PRIVATE FUNCTIONS
+// --------------------------------------------------------------------------------------------------------------------
+static void it_enable_disable()
+{
+}
+
+static void rx_stop()
+{
+}
+
+static void rx_resume()
+{
+    rx_resumer_entered.set();
+    rx_resumer_released.wait_set();
+}
+
+static void byte_send(char c)
+{
+}
+
+static void helper_receive(test_char_driver &drv, std::string_view data)
+{
+    drv.rx_isr_handler(data.data(), data.size());
+}
@@ -0,0 +1,90 @@
+/**
+ * @file	test_os_mpmc_queue.cpp
+ * @brief	Tests os_mpmc_queue template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_mpmc_queue.hpp"
+#include "os_task.hpp"
+#include "unity.h"
+#include <atomic>
+#include <string>
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_elements_are_received_in_fifo_order();
+static void UNIT_TEST_2_send_fails_when_queue_is_full_and_receive_times_out_when_empty();
+static void UNIT_TEST_3_multiple_producers_multiple_consumers();
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_mpmc_queue()
+{
+    RUN_TEST(UNIT_TEST_1_elements_are_received_in_fifo_order);
+    RUN_TEST(UNIT_TEST_2_send_fails_when_queue_is_full_and_receive_times_out_when_empty);
+    RUN_TEST(UNIT_TEST_3_multiple_producers_multiple_consumers);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_elements_are_received_in_fifo_order()
+{
+    os_mpmc_queue<std::string, 4> q;
+
+    for (int round = 0; round < 5; ++round)
+    {
+        TEST_ASSERT_TRUE(q.send("first"));
+        TEST_ASSERT_TRUE(q.send(3, 's'));
+
+        auto r1 = q.receive(0);
+        auto r2 = q.receive(0);
+        TEST_ASSERT_TRUE(r1.isLeft);
+        TEST_ASSERT_TRUE(r2.isLeft);
+        TEST_ASSERT_EQUAL_STRING("first", r1.leftValue.c_str());
+        TEST_ASSERT_EQUAL_STRING("sss", r2.leftValue.c_str());
+    }
+}
+
+static void UNIT_TEST_2_send_fails_when_queue_is_full_and_receive_times_out_when_empty()
+{
+    os_mpmc_queue<int, 2> q;
+
+    TEST_ASSERT_TRUE(q.send(1));
+    TEST_ASSERT_TRUE(q.send(2));
+    TEST_ASSERT_FALSE(q.send(3));
+
+    TEST_ASSERT_EQUAL_INT(1, q.receive(0).leftValue);
+    TEST_ASSERT_EQUAL_INT(2, q.receive(0).leftValue);
+    TEST_ASSERT_FALSE(q.receive(pdMS_TO_TICKS(5)).isLeft);
+}
+
+static void UNIT_TEST_3_multiple_producers_multiple_consumers()
+{
+    static constexpr int num_elems_per_producer = 50;
+    static constexpr int expected_sum = num_elems_per_producer * (num_elems_per_producer + 1);
+    os_mpmc_queue<int, 8> q;
+    std::atomic<int> sum{0};
+
+    auto producer = [&q]() {
+        for (int i = 1; i <= num_elems_per_producer; ++i)
+            while (!q.send(i))
+                os_delay_ms(1);
+    };
+    auto consumer = [&q, &sum]() {
+        for (int i = 0; i < num_elems_per_producer; ++i)
+            sum += q.receive(portMAX_DELAY).leftValue;
+    };
+
+    os_task consumer_task_1(consumer, "consumer_1", 256, 1);
+    os_task consumer_task_2(consumer, "consumer_2", 256, 1);
+    os_task producer_task_1(producer, "producer_1", 256, 1);
+    os_task producer_task_2(producer, "producer_2", 256, 1);
+
+    for (unsigned waited_ms = 0; sum != expected_sum && waited_ms < 1000; ++waited_ms)
+        os_delay_ms(1);
+    TEST_ASSERT_EQUAL_INT(expected_sum, sum);
+}
@@ -0,0 +1,123 @@
+/**
+ * @file	test_os_periodic_task.cpp
+ * @brief	Tests os_periodic_task class
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_flag.hpp"
+#include "os_periodic_task.hpp"
+#include "unity.h"
+#include <atomic>
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_task_code_is_run_at_fixed_period_without_drift();
+static void UNIT_TEST_2_overrunning_task_code_skips_the_started_periods();
+static void UNIT_TEST_3_period_shorter_than_a_tick_lasts_one_tick();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+//! Outlives the tasks, which may still be in set() when the test case returns.
+static os_flag periods_done;
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_periodic_task()
+{
+    RUN_TEST(UNIT_TEST_1_task_code_is_run_at_fixed_period_without_drift);
+    RUN_TEST(UNIT_TEST_2_overrunning_task_code_skips_the_started_periods);
+    RUN_TEST(UNIT_TEST_3_period_shorter_than_a_tick_lasts_one_tick);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_task_code_is_run_at_fixed_period_without_drift()
+{
+    periods_done.reset();
+    constexpr unsigned period_ms = 20, execution_time_ms = 10, num_periods = 5;
+    std::atomic<unsigned> num_runs{0};
+    os_tick_type_t release_times[num_periods];
+
+    os_periodic_task task(
+        [&num_runs, &release_times]() {
+            auto run = num_runs.load();
+            if (run < num_periods)
+                release_times[run] = os_get_tick_count();
+            os_delay_ms(execution_time_ms);
+            if (num_runs.fetch_add(1) + 1 == num_periods)
+                periods_done.set();
+        },
+        "periodic",
+        256,
+        1,
+        period_ms);
+    periods_done.wait_set();
+    // The statistics of the last period are updated after the task code returns.
+    while (task.stats().num_periods < num_periods)
+        os_delay_ms(1);
+
+    // The time spent in the task code and in waking up doesn't accumulate. A run may start late by less than a period,
+    // or by more when the periods it has missed are skipped, which is accounted as overruns.
+    os_tick_type_t period = os_timeout_to_ticks(period_ms);
+    os_tick_type_t num_skipped_periods = task.stats().num_overruns;
+    auto elapsed = release_times[num_periods - 1] - release_times[0];
+    TEST_ASSERT_TRUE(elapsed >= (num_periods - 1) * (period - 1));
+    TEST_ASSERT_TRUE(elapsed < (num_periods + num_skipped_periods) * period);
+}
+
+static void UNIT_TEST_2_overrunning_task_code_skips_the_started_periods()
+{
+    periods_done.reset();
+    constexpr unsigned period_ms = 10, execution_time_ms = 25;
+    std::atomic<unsigned> num_runs{0};
+
+    os_periodic_task task(
+        [&num_runs]() {
+            os_delay_ms(execution_time_ms);
+            if (num_runs.fetch_add(1) + 1 == 3)
+                periods_done.set();
+        },
+        "periodic",
+        256,
+        1,
+        period_ms);
+    periods_done.wait_set();
+
+    // The statistics of the last period are updated after the task code returns.
+    auto stats = task.stats();
+    TEST_ASSERT_TRUE(stats.num_periods >= 2);
+    TEST_ASSERT_TRUE(stats.num_deadline_misses >= 2);
+    // Each run takes more than two periods.
+    TEST_ASSERT_TRUE(stats.num_overruns >= 4);
+    TEST_ASSERT_TRUE(stats.worst_case_execution_time > 0);
+}
+
+static void UNIT_TEST_3_period_shorter_than_a_tick_lasts_one_tick()
+{
+    periods_done.reset();
+    constexpr unsigned num_periods = 5;
+    std::atomic<unsigned> num_runs{0};
+    os_tick_type_t release_times[num_periods];
+
+    os_periodic_task task(
+        [&num_runs, &release_times]() {
+            auto run = num_runs.load();
+            if (run < num_periods)
+                release_times[run] = os_get_tick_count();
+            if (num_runs.fetch_add(1) + 1 == num_periods)
+                periods_done.set();
+        },
+        "periodic",
+        256,
+        1,
+        0);
+    periods_done.wait_set();
+
+    // Each run waits for the next tick, instead of dividing by a zero period.
+    TEST_ASSERT_TRUE(release_times[num_periods - 1] - release_times[0] >= num_periods - 1);
+}
@@ -0,0 +1,96 @@
+/**
+ * @file	test_os_priority_queue.cpp
+ * @brief	Tests os_priority_queue template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_priority_queue.hpp"
+#include "os_task.hpp"
+#include "unity.h"
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_higher_priority_overtakes_and_equal_priorities_keep_order();
+static void UNIT_TEST_2_send_fails_when_queue_is_full();
+static void UNIT_TEST_3_block_on_receive_and_unblock_on_send();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+struct message
+{
+    unsigned priority;
+    int id;
+};
+
+struct message_priority_less
+{
+    bool operator()(const message &lhs, const message &rhs) const
+    {
+        return lhs.priority < rhs.priority;
+    }
+};
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_priority_queue()
+{
+    RUN_TEST(UNIT_TEST_1_higher_priority_overtakes_and_equal_priorities_keep_order);
+    RUN_TEST(UNIT_TEST_2_send_fails_when_queue_is_full);
+    RUN_TEST(UNIT_TEST_3_block_on_receive_and_unblock_on_send);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_higher_priority_overtakes_and_equal_priorities_keep_order()
+{
+    os_priority_queue<message, 8, message_priority_less> q;
+
+    q.send(message{0, 1});
+    q.send(message{0, 2});
+    q.send(message{2, 3});
+    q.send(message{0, 4});
+    q.send(message{1, 5});
+    q.send(message{2, 6});
+    q.send(message{0, 7});
+
+    for (int expected_id : {3, 6, 5, 1, 2, 4, 7})
+    {
+        auto r = q.receive(0);
+        TEST_ASSERT_TRUE(r.isLeft);
+        TEST_ASSERT_EQUAL_INT(expected_id, r.leftValue.id);
+    }
+    TEST_ASSERT_FALSE(q.receive(pdMS_TO_TICKS(5)).isLeft);
+}
+
+static void UNIT_TEST_2_send_fails_when_queue_is_full()
+{
+    os_priority_queue<int, 2> q;
+
+    TEST_ASSERT_TRUE(q.send(1));
+    TEST_ASSERT_TRUE(q.send(2));
+    TEST_ASSERT_FALSE(q.send(3));
+    TEST_ASSERT_EQUAL_INT(2, q.receive(0).leftValue);
+}
+
+static void UNIT_TEST_3_block_on_receive_and_unblock_on_send()
+{
+    os_priority_queue<int, 2> q;
+
+    os_task producer_task(
+        [&q]() {
+            os_delay_ms(10);
+            q.send(42);
+        },
+        "producer",
+        256,
+        1);
+
+    auto r = q.receive(portMAX_DELAY);
+    TEST_ASSERT_TRUE(r.isLeft);
+    TEST_ASSERT_EQUAL_INT(42, r.leftValue);
+}
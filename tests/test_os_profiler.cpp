@@ -0,0 +1,69 @@
+/**
+ * @file	test_os_profiler.cpp
+ * @brief	Tests os_profiler template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_profiler.hpp"
+#include "unity.h"
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_registered_task_is_reported_under_its_name();
+static void UNIT_TEST_2_cpu_usage_of_the_tasks_sums_up_to_at_most_100_percent();
+static void UNIT_TEST_3_snapshot_fails_when_the_buffer_is_too_small();
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_profiler()
+{
+    RUN_TEST(UNIT_TEST_1_registered_task_is_reported_under_its_name);
+    RUN_TEST(UNIT_TEST_2_cpu_usage_of_the_tasks_sums_up_to_at_most_100_percent);
+    RUN_TEST(UNIT_TEST_3_snapshot_fails_when_the_buffer_is_too_small);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_registered_task_is_reported_under_its_name()
+{
+    os_profiler<16> profiler;
+    TEST_ASSERT_TRUE(profiler.register_task(os_task_get_current_task_handle(), "profiled"));
+
+    TEST_ASSERT_TRUE(profiler.snapshot());
+
+    auto profile = profiler.find("profiled");
+    TEST_ASSERT_TRUE(profile != nullptr);
+    TEST_ASSERT_TRUE(profile->handle == os_task_get_current_task_handle());
+    TEST_ASSERT_TRUE(profile->stack_high_water_mark > 0);
+    TEST_ASSERT_TRUE(profiler.find("not existing") == nullptr);
+}
+
+static void UNIT_TEST_2_cpu_usage_of_the_tasks_sums_up_to_at_most_100_percent()
+{
+    os_profiler<16> profiler;
+    TEST_ASSERT_TRUE(profiler.snapshot());
+    os_delay_ms(10);
+    TEST_ASSERT_TRUE(profiler.snapshot());
+
+    // How much of the time is accounted depends on the resolution of the run time counter and on the host, so only
+    // the upper bound is checked, with room for the rounding.
+    constexpr float rounding_epsilon = 1.0f;
+    float sum = 0;
+    for (auto &profile : profiler)
+    {
+        TEST_ASSERT_TRUE(profile.cpu_percent >= 0.0f && profile.cpu_percent <= 100.0f);
+        sum += profile.cpu_percent;
+    }
+    TEST_ASSERT_TRUE(sum <= 100.0f + rounding_epsilon);
+}
+
+static void UNIT_TEST_3_snapshot_fails_when_the_buffer_is_too_small()
+{
+    os_profiler<1> profiler;
+    TEST_ASSERT_FALSE(profiler.snapshot());
+    TEST_ASSERT_EQUAL_UINT(0, profiler.size());
+}
@@ -0,0 +1,248 @@
+/**
+ * @file	test_os_queue.cpp
+ * @brief	Tests os_queue template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_queue.hpp"
+#include "os_task.hpp"
+#include "unity.h"
+#include <array>
+#include <csignal>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <vector>
+
+using namespace jungles;
+#define SIGNAL_QUEUE_ISR (SIGRTMIN + 2)
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+static std::function<void(void)> queue_isr_handler;
+static void queue_isr_handler_callback(int signal);
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_elements_are_received_in_fifo_order();
+static void UNIT_TEST_2_send_fails_when_queue_is_full();
+static void UNIT_TEST_3_receive_times_out_on_empty_queue();
+static void UNIT_TEST_4_ring_buffer_wraps_around();
+static void UNIT_TEST_5_block_on_receive_and_unblock_on_send();
+static void UNIT_TEST_6_batched_send_receive_and_drain();
+static void UNIT_TEST_7_send_from_isr_unblocks_receiver();
+static void UNIT_TEST_8_construct_in_place_and_borrow_without_moving();
+static void UNIT_TEST_9_instrumented_queue_gathers_stats();
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_queue()
+{
+    std::signal(SIGNAL_QUEUE_ISR, queue_isr_handler_callback);
+
+    RUN_TEST(UNIT_TEST_1_elements_are_received_in_fifo_order);
+    RUN_TEST(UNIT_TEST_2_send_fails_when_queue_is_full);
+    RUN_TEST(UNIT_TEST_3_receive_times_out_on_empty_queue);
+    RUN_TEST(UNIT_TEST_4_ring_buffer_wraps_around);
+    RUN_TEST(UNIT_TEST_5_block_on_receive_and_unblock_on_send);
+    RUN_TEST(UNIT_TEST_6_batched_send_receive_and_drain);
+    RUN_TEST(UNIT_TEST_7_send_from_isr_unblocks_receiver);
+    RUN_TEST(UNIT_TEST_8_construct_in_place_and_borrow_without_moving);
+    RUN_TEST(UNIT_TEST_9_instrumented_queue_gathers_stats);
+
+    std::signal(SIGNAL_QUEUE_ISR, SIG_DFL);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_elements_are_received_in_fifo_order()
+{
+    os_queue<std::string, 4> q;
+
+    TEST_ASSERT_TRUE(q.send("first"));
+    TEST_ASSERT_TRUE(q.send(3, 's'));
+    TEST_ASSERT_TRUE(q.send(std::string{"third"}));
+
+    auto r1 = q.receive(0);
+    auto r2 = q.receive(0);
+    auto r3 = q.receive(0);
+    TEST_ASSERT_TRUE(r1.isLeft);
+    TEST_ASSERT_TRUE(r2.isLeft);
+    TEST_ASSERT_TRUE(r3.isLeft);
+    TEST_ASSERT_EQUAL_STRING("first", r1.leftValue.c_str());
+    TEST_ASSERT_EQUAL_STRING("sss", r2.leftValue.c_str());
+    TEST_ASSERT_EQUAL_STRING("third", r3.leftValue.c_str());
+}
+
+static void UNIT_TEST_2_send_fails_when_queue_is_full()
+{
+    os_queue<int, 2> q;
+
+    TEST_ASSERT_TRUE(q.send(1));
+    TEST_ASSERT_TRUE(q.send(2));
+    TEST_ASSERT_FALSE(q.send(3));
+
+    auto r = q.receive(0);
+    TEST_ASSERT_TRUE(r.isLeft);
+    TEST_ASSERT_EQUAL_INT(1, r.leftValue);
+    TEST_ASSERT_TRUE(q.send(3));
+}
+
+static void UNIT_TEST_3_receive_times_out_on_empty_queue()
+{
+    os_queue<int, 2> q;
+
+    auto r = q.receive(pdMS_TO_TICKS(5));
+    TEST_ASSERT_FALSE(r.isLeft);
+}
+
+static void UNIT_TEST_4_ring_buffer_wraps_around()
+{
+    os_queue<int, 3> q;
+
+    for (int i = 0; i < 20; ++i)
+    {
+        TEST_ASSERT_TRUE(q.send(i));
+        TEST_ASSERT_TRUE(q.send(i + 100));
+        auto r1 = q.receive(0);
+        auto r2 = q.receive(0);
+        TEST_ASSERT_EQUAL_INT(i, r1.leftValue);
+        TEST_ASSERT_EQUAL_INT(i + 100, r2.leftValue);
+    }
+}
+
+static void UNIT_TEST_5_block_on_receive_and_unblock_on_send()
+{
+    os_queue<int, 2> q;
+
+    os_task producer_task(
+        [&q]() {
+            os_delay_ms(10);
+            q.send(42);
+        },
+        "producer",
+        256,
+        1);
+
+    auto r = q.receive(portMAX_DELAY);
+    TEST_ASSERT_TRUE(r.isLeft);
+    TEST_ASSERT_EQUAL_INT(42, r.leftValue);
+}
+
+static void UNIT_TEST_6_batched_send_receive_and_drain()
+{
+    os_queue<int, 4> q;
+    std::array<int, 6> in{1, 2, 3, 4, 5, 6};
+    std::array<int, 4> out{};
+
+    TEST_ASSERT_EQUAL_UINT(4, q.send_n(std::begin(in), std::end(in)));
+    TEST_ASSERT_EQUAL_UINT(3, q.receive_n(std::begin(out), 3, 0));
+    TEST_ASSERT_EQUAL_INT_ARRAY(in.data(), out.data(), 3);
+
+    TEST_ASSERT_EQUAL_UINT(2, q.send_n(std::begin(in) + 4, std::end(in)));
+    std::vector<int> drained;
+    TEST_ASSERT_EQUAL_UINT(3, q.drain(std::back_inserter(drained)));
+    TEST_ASSERT_EQUAL_INT_ARRAY(in.data() + 3, drained.data(), 3);
+
+    TEST_ASSERT_EQUAL_UINT(0, q.drain(std::begin(out)));
+    TEST_ASSERT_EQUAL_UINT(0, q.receive_n(std::begin(out), 4, pdMS_TO_TICKS(5)));
+}
+
+static void UNIT_TEST_7_send_from_isr_unblocks_receiver()
+{
+    os_queue<int, 4> q;
+
+    queue_isr_handler = [&q]() {
+        q.send_from_isr(7);
+        q.send_from_isr(8);
+    };
+    os_task isr_trigger_task(
+        []() {
+            os_delay_ms(10);
+            std::raise(SIGNAL_QUEUE_ISR);
+        },
+        "isr_trigger",
+        256,
+        1);
+
+    auto r1 = q.receive(portMAX_DELAY);
+    TEST_ASSERT_TRUE(r1.isLeft);
+    TEST_ASSERT_EQUAL_INT(7, r1.leftValue);
+
+    queue_isr_handler = [&q]() {
+        auto r = q.receive_from_isr();
+        TEST_ASSERT_TRUE(r.isLeft);
+        TEST_ASSERT_EQUAL_INT(8, r.leftValue);
+        TEST_ASSERT_FALSE(q.receive_from_isr().isLeft);
+    };
+    std::raise(SIGNAL_QUEUE_ISR);
+}
+
+static void UNIT_TEST_8_construct_in_place_and_borrow_without_moving()
+{
+    struct frame
+    {
+        explicit frame(int id) : id{id}
+        {
+        }
+
+        frame(const frame &) = delete;
+        frame(frame &&) = delete;
+
+        int id;
+        std::array<char, 512> payload;
+    };
+
+    os_queue<frame, 2> q;
+
+    for (int id = 1; id <= 2; ++id)
+    {
+        auto storage = q.prepare();
+        TEST_ASSERT_TRUE(storage != nullptr);
+        new (storage) frame{id};
+        q.commit();
+    }
+    TEST_ASSERT_TRUE(q.prepare() == nullptr);
+
+    for (int id = 1; id <= 2; ++id)
+    {
+        auto f = q.peek(0);
+        TEST_ASSERT_TRUE(f != nullptr);
+        TEST_ASSERT_EQUAL_INT(id, f->id);
+        q.release();
+    }
+    TEST_ASSERT_TRUE(q.peek(pdMS_TO_TICKS(5)) == nullptr);
+}
+
+static void UNIT_TEST_9_instrumented_queue_gathers_stats()
+{
+    static_assert(sizeof(os_queue<int, 4>) < sizeof(os_queue<int, 4, true>));
+
+    os_queue<int, 2, true> q;
+
+    q.send(1);
+    q.send(2);
+    q.send(3);
+    q.receive(0);
+    q.receive(0);
+
+    auto &stats = q.stats();
+    TEST_ASSERT_EQUAL_UINT(2, stats.max_depth);
+    TEST_ASSERT_EQUAL_UINT(1, stats.num_rejected_sends);
+
+    uint32_t num_latencies = 0;
+    for (auto &bucket : stats.latency_histogram)
+        num_latencies += bucket;
+    TEST_ASSERT_EQUAL_UINT(2, num_latencies);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PRIVATE FUNCTIONS
+// --------------------------------------------------------------------------------------------------------------------
+static void queue_isr_handler_callback(int signal)
+{
+    queue_isr_handler();
+}
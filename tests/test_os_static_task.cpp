@@ -0,0 +1,81 @@
+/**
+ * @file	test_os_static_task.cpp
+ * @brief	Tests os_static_task template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_flag.hpp"
+#include "os_static_task.hpp"
+#include "unity.h"
+#include <string>
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_task_runs_the_function();
+static void UNIT_TEST_2_task_runs_the_lambda_with_captures();
+static void UNIT_TEST_3_stack_and_task_control_block_are_stored_within_the_object();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+//! Outlives the tasks, which may still be in set() when the test case returns.
+static os_flag task_executed;
+
+static void task_code();
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_static_task()
+{
+    RUN_TEST(UNIT_TEST_1_task_runs_the_function);
+    RUN_TEST(UNIT_TEST_2_task_runs_the_lambda_with_captures);
+    RUN_TEST(UNIT_TEST_3_stack_and_task_control_block_are_stored_within_the_object);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_task_runs_the_function()
+{
+    task_executed.reset();
+
+    os_static_task<256> task(&task_code, "static", 1);
+
+    task_executed.wait_set();
+    TEST_ASSERT_TRUE(task_executed.is_set());
+}
+
+static void UNIT_TEST_2_task_runs_the_lambda_with_captures()
+{
+    task_executed.reset();
+    std::string result;
+    unsigned a = 2, b = 3, c = 4;
+
+    auto task = make_os_static_task<256>(
+        [&result, a, b, c]() {
+            result = std::to_string(a * b * c);
+            task_executed.set();
+        },
+        "static",
+        1);
+
+    task_executed.wait_set();
+    TEST_ASSERT_EQUAL_STRING("24", result.c_str());
+}
+
+static void UNIT_TEST_3_stack_and_task_control_block_are_stored_within_the_object()
+{
+    TEST_ASSERT_TRUE(sizeof(os_static_task<256>) >= sizeof(os_stack_type_t) * 256 + sizeof(os_static_task_t));
+    TEST_ASSERT_TRUE(sizeof(os_static_task<512>) - sizeof(os_static_task<256>) == sizeof(os_stack_type_t) * 256);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF PRIVATE FUNCTIONS
+// --------------------------------------------------------------------------------------------------------------------
+static void task_code()
+{
+    task_executed.set();
+}
@@ -0,0 +1,84 @@
+/**
+ * @file	test_os_task.cpp
+ * @brief	Tests os_task class
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_flag.hpp"
+#include "os_queue.hpp"
+#include "os_task.hpp"
+#include "unity.h"
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_task_pinned_to_a_core_runs();
+static void UNIT_TEST_2_colocated_tasks_share_the_core_affinity();
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF PRIVATE FUNCTIONS AND VARIABLES
+// --------------------------------------------------------------------------------------------------------------------
+//! Outlives the tasks, which may still be in set() when the test case returns.
+static os_flag task_done;
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_task()
+{
+    RUN_TEST(UNIT_TEST_1_task_pinned_to_a_core_runs);
+    RUN_TEST(UNIT_TEST_2_colocated_tasks_share_the_core_affinity);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_task_pinned_to_a_core_runs()
+{
+    task_done.reset();
+    auto last_core = os_core_affinity_of(os_num_cores - 1);
+    os_task task([]() { task_done.set(); }, "pinned", 256, 1, last_core);
+
+    task_done.wait_set();
+#if os_has_core_affinity
+    TEST_ASSERT_EQUAL_UINT(last_core, task.get_core_affinity());
+#else
+    TEST_ASSERT_EQUAL_UINT(os_core_affinity_any, task.get_core_affinity());
+#endif
+}
+
+static void UNIT_TEST_2_colocated_tasks_share_the_core_affinity()
+{
+    task_done.reset();
+    os_queue<int, 4> queue;
+    int sum = 0;
+
+    os_task consumer(
+        [&queue, &sum]() {
+            for (int i = 0; i < 3; ++i)
+                sum += queue.receive(os_no_timeout).leftValue;
+            task_done.set();
+        },
+        "consumer",
+        256,
+        1);
+    os_task producer(
+        [&queue]() {
+            for (int i = 1; i <= 3; ++i)
+                queue.send(i);
+        },
+        "producer",
+        256,
+        1);
+    // Neither task is pinned, so both go to the preferred core.
+    auto last_core = os_num_cores - 1;
+    producer.colocate_with(consumer, last_core);
+
+    task_done.wait_set();
+    TEST_ASSERT_EQUAL_INT(6, sum);
+    TEST_ASSERT_EQUAL_UINT(consumer.get_core_affinity(), producer.get_core_affinity());
+#if os_has_core_affinity
+    TEST_ASSERT_EQUAL_UINT(os_core_affinity_of(last_core), producer.get_core_affinity());
+#endif
+}
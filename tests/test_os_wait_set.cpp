@@ -0,0 +1,91 @@
+/**
+ * @file	test_os_wait_set.cpp
+ * @brief	Tests os_wait_set template
+ * @author	Kacper Kowalski - kacper.s.kowalski@gmail.com
+ */
+#include "os_flag.hpp"
+#include "os_queue.hpp"
+#include "os_task.hpp"
+#include "os_wait_set.hpp"
+#include "unity.h"
+
+using namespace jungles;
+
+// --------------------------------------------------------------------------------------------------------------------
+// DECLARATION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_wait_times_out_when_no_member_is_ready();
+static void UNIT_TEST_2_block_on_multiple_members_and_unblock_on_any();
+static void UNIT_TEST_3_ready_members_are_reported_in_round_robin_order();
+
+// --------------------------------------------------------------------------------------------------------------------
+// EXECUTION OF THE TESTS
+// --------------------------------------------------------------------------------------------------------------------
+void test_os_wait_set()
+{
+    RUN_TEST(UNIT_TEST_1_wait_times_out_when_no_member_is_ready);
+    RUN_TEST(UNIT_TEST_2_block_on_multiple_members_and_unblock_on_any);
+    RUN_TEST(UNIT_TEST_3_ready_members_are_reported_in_round_robin_order);
+}
+
+// --------------------------------------------------------------------------------------------------------------------
+// DEFINITION OF THE TEST CASES
+// --------------------------------------------------------------------------------------------------------------------
+static void UNIT_TEST_1_wait_times_out_when_no_member_is_ready()
+{
+    os_queue<int, 2> q;
+    os_flag f;
+    os_wait_set<2> ws;
+    ws.add(q);
+    ws.add(f);
+
+    TEST_ASSERT_FALSE(ws.wait(pdMS_TO_TICKS(5)).isLeft);
+}
+
+static void UNIT_TEST_2_block_on_multiple_members_and_unblock_on_any()
+{
+    os_queue<int, 2> q1, q2;
+    os_flag f;
+    os_wait_set<3> ws;
+    ws.add(q1);
+    auto q2_idx = ws.add(q2);
+    auto f_idx = ws.add(f);
+
+    os_task producer_task(
+        [&q2, &f]() {
+            os_delay_ms(10);
+            q2.send(2);
+            os_delay_ms(10);
+            f.set();
+        },
+        "producer",
+        256,
+        1);
+
+    auto r1 = ws.wait(portMAX_DELAY);
+    TEST_ASSERT_TRUE(r1.isLeft);
+    TEST_ASSERT_EQUAL_UINT(q2_idx, r1.leftValue);
+    TEST_ASSERT_EQUAL_INT(2, q2.receive(0).leftValue);
+
+    auto r2 = ws.wait(portMAX_DELAY);
+    TEST_ASSERT_TRUE(r2.isLeft);
+    TEST_ASSERT_EQUAL_UINT(f_idx, r2.leftValue);
+    TEST_ASSERT_TRUE(f.is_set());
+    TEST_ASSERT_FALSE(q1.is_ready());
+}
+
+static void UNIT_TEST_3_ready_members_are_reported_in_round_robin_order()
+{
+    os_queue<int, 4> q1, q2;
+    os_wait_set<2> ws;
+    auto q1_idx = ws.add(q1);
+    auto q2_idx = ws.add(q2);
+
+    q1.send(1);
+    q1.send(1);
+    q2.send(2);
+
+    TEST_ASSERT_EQUAL_UINT(q1_idx, ws.wait(0).leftValue);
+    TEST_ASSERT_EQUAL_UINT(q2_idx, ws.wait(0).leftValue);
+    TEST_ASSERT_EQUAL_UINT(q1_idx, ws.wait(0).leftValue);
+}